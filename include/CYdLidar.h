@@ -52,7 +52,10 @@
 #pragma once
 #include "utils.h"
 #include "ydlidar_driver.h"
+#include "lidar_manager.h"
+#include "scan_lease.h"
 #include <math.h>
+#include <functional>
 
 using namespace ydlidar;
 
@@ -420,6 +423,39 @@ class YDLIDAR_API CYdLidar {
    * @see CYdLidar::setFixedResolution and CYdLidar::getFixedResolution
    */
   PropertyBuilderByName(bool, FixedResolution, private);
+  /**
+   * @brief Set and Get reduction of the fixed angular resolution bins.\n
+   * With a reduction other than [BIN_NONE](\ref BinReductionID::BIN_NONE) and
+   * FixedResolution enabled, every sample is placed in the bin nearest to its
+   * angle, so points[i] always covers min_angle + i * angle_increment.
+   * Several samples in one bin are reduced as selected; only valid samples
+   * take part, a bin with none of them has range 0.\n
+   * default: [BIN_NONE](\ref BinReductionID::BIN_NONE), points in arrival order.
+   * @see [BinReductionID](\ref BinReductionID)
+   * @see CYdLidar::setFixedResolutionReduction and CYdLidar::getFixedResolutionReduction
+   */
+  PropertyBuilderByName(int, FixedResolutionReduction, private);
+  /**
+   * @brief Set and Get largest run of empty bins filled by interpolation.\n
+   * A run of at most this many bins that received no sample is filled by
+   * linear interpolation between the valid bins on both sides.
+   * Bins holding only invalid samples are never filled.\n
+   * default: 0, no interpolation.
+   * @note Only used with a FixedResolutionReduction other than BIN_NONE.
+   * @see CYdLidar::setMaxInterpolationGap and CYdLidar::getMaxInterpolationGap
+   */
+  PropertyBuilderByName(int, MaxInterpolationGap, private);
+  /**
+   * @brief Set and Get fields filled by doProcessSimple(LaserScanSoA &).\n
+   * Bitwise or of [ScanFieldID](\ref ScanFieldID); unselected arrays stay empty,
+   * so a ranges-only consumer only pays for the range array.\n
+   * [SCAN_FIELD_CARTESIAN](\ref ScanFieldID::SCAN_FIELD_CARTESIAN) adds x/y
+   * arrays; with fixed resolution binning the per-bin unit vectors are cached,
+   * so the conversion costs one multiply per coordinate.\n
+   * default: [SCAN_FIELD_POLAR](\ref ScanFieldID::SCAN_FIELD_POLAR)
+   * @see CYdLidar::setScanFields and CYdLidar::getScanFields
+   */
+  PropertyBuilderByName(int, ScanFields, private);
   /**
    * @brief Set and Get LiDAR Reversion.\n
    * true: LiDAR data rotated 180 degrees.\n
@@ -551,6 +587,54 @@ class YDLIDAR_API CYdLidar {
   * @see CYdLidar::setLidarType and CYdLidar::getLidarType
   */
   PropertyBuilderByName(int, LidarType, private);
+  /**
+   * @brief Set and Get scan queue depth.
+   * @note Number of finished scans buffered between the driver thread and
+   * ::doProcessSimple. The default depth of 1 with
+   * [QUEUE_DROP_OLDEST](\ref ScanQueuePolicyID::QUEUE_DROP_OLDEST) always
+   * returns the latest scan; a deeper queue lets a slow consumer catch up
+   * on every revolution.
+   * @see CYdLidar::setScanQueueSize and CYdLidar::getScanQueueSize
+   */
+  PropertyBuilderByName(int, ScanQueueSize, private);
+  /**
+   * @brief Set and Get scan queue overflow policy.
+   * @see [ScanQueuePolicyID](\ref ScanQueuePolicyID)
+   * @see CYdLidar::setScanQueuePolicy and CYdLidar::getScanQueuePolicy
+   */
+  PropertyBuilderByName(int, ScanQueuePolicy, private);
+  /**
+   * @brief Set and Get low latency serial mode.
+   * @note Opt-in. Sets VMIN/VTIME, ASYNC_LOW_LATENCY and the USB serial
+   * adapter latency_timer (16 ms by default on FTDI) to 1 ms so data is not
+   * delivered in bursts; the previous settings are restored on disconnect.
+   * Which settings took effect is printed on connect.\n
+   * default: false
+   * @see CYdLidar::setLowLatency and CYdLidar::getLowLatency
+   */
+  PropertyBuilderByName(bool, LowLatency, private);
+  /**
+   * @brief Set and Get target driver wakeups per second.
+   * @note For low-power hosts that don't need per-package latency. The scan
+   * thread wakes on a fixed cadence and decodes everything buffered instead
+   * of waking for every package header and payload. 0 disables batching;
+   * the interval never exceeds the time it takes to fill the 4 KiB receive
+   * buffer at the current baudrate. Scans are finished in bursts, so raise
+   * ::ScanQueueSize above ScanFrequency / WakeupRate to keep every scan.\n
+   * default: 0
+   * @see CYdLidar::setWakeupRate and CYdLidar::getWakeupRate
+   */
+  PropertyBuilderByName(int, WakeupRate, private);
+  /**
+   * @brief Set and Get number of threads running
+   * [CALLBACK_WORKER](\ref ScanCallbackExecutorID::CALLBACK_WORKER) callbacks.
+   * @note With more than one thread consecutive scans of one subscriber may
+   * be delivered concurrently and out of order.\n
+   * default: 1
+   * @see CYdLidar::subscribe
+   * @see CYdLidar::setCallbackThreads and CYdLidar::getCallbackThreads
+   */
+  PropertyBuilderByName(int, CallbackThreads, private);
 
  public:
   CYdLidar(); //!< Constructor
@@ -565,6 +649,58 @@ class YDLIDAR_API CYdLidar {
   bool doProcessSimple(LaserScan &outscan,
                        bool &hardwareError);
 
+  // Same as above with one contiguous array per field, see setScanFields
+  bool doProcessSimple(LaserScanSoA &outscan,
+                       bool &hardwareError);
+
+  /**
+   * @brief Same as doProcessSimple, but the scan stays in storage owned by
+   * this object and is lent out as a read-only view instead of being
+   * converted into a caller owned LaserScan.
+   * @param lease replaced by the new scan, the scan it held before is
+   * handed back first
+   * @return false on error or if all SCAN_LEASE_SLOTS scans are still leased
+   * @see LaserScanLease
+   */
+  bool borrowScan(LaserScanLease &lease, bool &hardwareError);
+
+  enum {
+    SCAN_LEASE_SLOTS = 4, ///< scans that can be leased at the same time
+  };
+
+  /// receives each finished scan, see subscribe
+  typedef std::function<void(const LaserScanLease &scan)> ScanCallback;
+
+  /**
+   * @brief Push finished scans to callback instead of polling doProcessSimple.
+   * @details Each revolution is converted once, on the driver thread (or
+   * the LidarManager reactor) as soon as it completes, and lent to every
+   * subscriber through the same LaserScanLease; copy the lease to keep the
+   * scan past the call.
+   * - [CALLBACK_INLINE](\ref ScanCallbackExecutorID::CALLBACK_INLINE) runs
+   *   callback on that thread, it must return quickly and must not call
+   *   turnOff.
+   * - [CALLBACK_WORKER](\ref ScanCallbackExecutorID::CALLBACK_WORKER) runs
+   *   callback on a pool of ::CallbackThreads threads started by turnOn.
+   *
+   * Scans are dropped, see getCallbackDropCount, while all SCAN_LEASE_SLOTS
+   * scans are still leased. Don't call doProcessSimple or borrowScan while
+   * there are subscribers.
+   * @param executor [ScanCallbackExecutorID](\ref ScanCallbackExecutorID)
+   * @return subscription id for unsubscribe, -1 while scanning
+   * @note Subscribe and unsubscribe while the lidar is turned off.
+   */
+  int subscribe(const ScanCallback &callback, int executor = CALLBACK_INLINE);
+
+  /**
+   * @brief Remove a subscription made with subscribe.
+   * @return false while scanning or for an unknown id
+   */
+  bool unsubscribe(int id);
+
+  //! get number of scans subscribers missed because every lease slot was held
+  uint32_t getCallbackDropCount() const;
+
   //Turn on the motor enable
   bool  turnOn();  //!< See base class docs
 
@@ -589,6 +725,13 @@ class YDLIDAR_API CYdLidar {
   //! get lidar serial number
   std::string getSerialNumber() const;
 
+  //! get number of scans dropped (or blocked) by a full scan queue
+  uint32_t getScanQueueOverflowCount() const;
+
+  //! parse scans in a reactor thread shared with other lidars, call before
+  //! initialize(); NULL (default) keeps a thread per lidar, see LidarManager
+  void setLidarManager(LidarManager *manager);
+
  protected:
   /*! Returns true if communication has been established with the device. If it's not,
     *  try to create a comms channel.
@@ -650,6 +793,82 @@ class YDLIDAR_API CYdLidar {
    */
   bool isRangeIgnore(double angle) const;
 
+  /*!
+   * @brief compile m_IgnoreArray into sorted, merged intervals
+   * and an angular bucket index, if it changed since the last call
+   */
+  void updateIgnoreMask();
+
+  /*!
+   * @brief rebuild the angle conversion table if the angle offset, reversion,
+   * inversion, angle window or ignore array changed since the last build
+   * @note turnOn clears the table first, the range scale depends on the model
+   */
+  void updateAngleTable();
+
+  /*!
+   * @brief check the hardware and convert the next scan into a LaserScan or
+   * LaserScanSoA, sleeps before returning if the lidar isn't scanning
+   */
+  template <typename ScanType>
+  bool processScan(ScanType &outscan, bool &hardwareError,
+                   uint32_t timeout = YDlidarDriver::DEFAULT_TIMEOUT);
+
+  /*!
+   * @brief convert the next scan without checking the hardware
+   * @param timeout how long to wait for the scan [ms]
+   * @return false if no scan came within timeout
+   */
+  template <typename ScanType>
+  bool convertScan(ScanType &outscan, uint32_t timeout);
+
+  /*!
+   * @brief take a lease slot no LaserScanLease refers to
+   * @return NULL if every slot is still being read
+   */
+  LaserScanSlot *acquireLeaseSlot();
+
+  /*!
+   * @brief driver hook, delivers the queued scans to the subscribers
+   */
+  static void onScanPublished(void *context);
+  void dispatchScans();
+
+  /*!
+   * @brief start or stop the CALLBACK_WORKER threads
+   */
+  void startCallbackWorkers();
+  void stopCallbackWorkers();
+
+  /*!
+   * @brief run queued CALLBACK_WORKER callbacks until stopped and drained
+   */
+  int runCallbackWorker();
+
+  /*!
+   * @brief reset size empty fixed resolution bins
+   */
+  void resetScanBins(int size);
+
+  /*!
+   * @brief reduce a sample into its fixed resolution bin
+   * @param weight angular distance of the sample from the bin centre
+   */
+  void reduceScanBin(int index, float weight, float range, float intensity);
+
+  /*!
+   * @brief finish the mean reduction and interpolate empty bins
+   */
+  void finishScanBins();
+
+  /*!
+   * @brief fill the x/y arrays of a scan if SCAN_FIELD_CARTESIAN is selected,
+   * then drop the polar arrays that were only collected for the conversion
+   * @param fixed_angles angles are min_angle + i * angle_increment
+   */
+  void updateCartesian(LaserScanSoA &outscan, int fields, bool fixed_angles);
+  void updateCartesian(LaserScan &, int, bool) {}
+
   /*!
    * @brief handleSingleChannelDevice
    */
@@ -657,10 +876,11 @@ class YDLIDAR_API CYdLidar {
 
   /**
    * @brief parsePackageNode
-   * @param node
+   * @param index debug index
+   * @param value debug value
    * @param info
    */
-  void parsePackageNode(const node_info &node, LaserDebug &info);
+  void parsePackageNode(uint8_t index, uint8_t value, LaserDebug &info);
 
   /**
    * @brief handleDeviceInfoPackage
@@ -675,18 +895,22 @@ class YDLIDAR_API CYdLidar {
   void printfVersionInfo(const device_info &info);
 
  private:
+  friend struct ydlidar::test::Access; ///< runs scans without hardware, see tests/
   bool    isScanning;
   int     m_FixedSize ;
   float   m_AngleOffset;
   bool    m_isAngleOffsetCorrected;
   float   frequencyOffset;
   int   lidar_model;
+  const LidarModelInfo *lidar_model_info; ///< Descriptor of lidar_model
   uint8_t Major;
   uint8_t Minjor;
   YDlidarDriver *lidarPtr;
+  LidarManager *lidarManager;
   uint64_t m_PointTime;
   uint64_t last_node_time;
-  node_info *global_nodes;
+  node_sample *global_nodes;
+  scan_info global_scan_info;
   std::map<int, int> SampleRateMap;
   bool m_ParseSuccess;
   std::string m_lidarSoftVer;
@@ -694,5 +918,75 @@ class YDLIDAR_API CYdLidar {
   std::string m_lidarSerialNum;
   int defalutSampleRate;
   int m_UserSampleRate;
+
+  enum {
+    IGNORE_MASK_BUCKETS = 720,  ///< angular buckets of the ignore mask (0.5 degree)
+  };
+  std::vector<float> ignore_mask_source;  ///< m_IgnoreArray the mask was built from
+  std::vector<std::pair<double, double> > ignore_intervals; ///< sorted, merged [min, max] in radians
+  std::vector<uint16_t> ignore_buckets; ///< first interval that may contain each bucket
+
+  /// per bin state of the fixed resolution reduction
+  struct ScanBin {
+    int samples;     ///< samples in the bin
+    int valid;       ///< valid samples in the bin
+    float weight;    ///< angular distance of the nearest sample
+    float range;     ///< reduced range
+    float intensity; ///< reduced intensity
+  };
+  std::vector<ScanBin> scan_bins;
+
+  /// output of the angle conversion for one angle_q6 value
+  struct AngleEntry {
+    float angle;  ///< offset, reversed, inverted and normalized angle [rad]
+    float scale;  ///< meters per distance_q2 unit, 0 inside an ignore interval
+    int inside;   ///< 1 inside [m_MinAngle, m_MaxAngle], else 0
+  };
+  std::vector<AngleEntry> angle_table; ///< indexed by angle_q6, 0 to 360 degrees
+  float angle_table_offset;     ///< m_AngleOffset the table was built with
+  bool angle_table_reversion;   ///< m_Reversion the table was built with
+  bool angle_table_inverted;    ///< m_Inverted the table was built with
+  float angle_table_min;        ///< m_MinAngle the table was built with
+  float angle_table_max;        ///< m_MaxAngle the table was built with
+  bool angle_window_full;       ///< every entry is inside the angle window
+
+  /// one scan converted by processScan before the window and fixed resolution
+  std::vector<float> point_angles;
+  std::vector<float> point_ranges;
+  std::vector<float> point_intensities;
+  std::vector<int> point_inside;
+
+  /// unit vectors of the Cartesian output
+  std::vector<float, AlignedAllocator<float> > unit_cos;
+  std::vector<float, AlignedAllocator<float> > unit_sin;
+  bool unit_cached;     ///< unit vectors hold min_angle + i * increment
+  float unit_min_angle; ///< min_angle of the cached unit vectors
+  float unit_increment; ///< angle_increment of the cached unit vectors
+
+  LaserScanSlot lease_slots[SCAN_LEASE_SLOTS]; ///< storage behind borrowScan
+
+  struct ScanSubscriber {
+    int id;
+    ScanCallback callback;
+    int executor;     ///< ScanCallbackExecutorID
+  };
+  std::vector<ScanSubscriber> scan_subscribers; ///< fixed while scanning
+  int next_subscriber_id;
+
+  /// a CALLBACK_WORKER callback waiting for a worker thread
+  struct CallbackTask {
+    size_t subscriber;    ///< index into scan_subscribers
+    LaserScanLease scan;
+  };
+  std::vector<CallbackTask> callback_tasks; ///< ring of pending tasks
+  size_t callback_head;         ///< oldest pending task
+  size_t callback_count;        ///< pending tasks
+  size_t callback_active;       ///< worker threads still running
+  bool callback_running;        ///< false asks the workers to drain and exit
+  Locker callback_lock;         ///< protects the task ring and the flags above
+  Event callback_event;         ///< a task was queued or the workers are stopping
+  Event callback_exited;        ///< the last running worker has exited
+  std::vector<Thread> callback_workers;
+  std::atomic<uint32_t> callback_drops;
 };	// End of class
 
@@ -76,135 +76,98 @@ enum YDLIDAR_RATE {
 };
 
 /*!
- * @brief lidarModelToString
- * @param model
- * @return
+ * @brief 雷达型号能力标志
  */
-inline std::string lidarModelToString(int model) {
-  std::string name = "unkown";
-
-  switch (model) {
-    case YDLIDAR_F4:
-      name = "F4";
-      break;
-
-    case YDLIDAR_T1:
-      name = "T1";
-
-      break;
-
-    case YDLIDAR_F2:
-      name = "F2";
-
-      break;
-
-    case YDLIDAR_S4:
-      name = "S4";
-
-      break;
-
-    case YDLIDAR_G4:
-      name = "G4";
-
-      break;
-
-    case YDLIDAR_X4:
-      name = "X4";
-
-      break;
-
-    case YDLIDAR_G4PRO:
-      name = "G4PRO";
-
-      break;
-
-    case YDLIDAR_F4PRO:
-      name = "F4PRO";
-
-      break;
-
-    case YDLIDAR_R2:
-      name = "R2";
-
-      break;
-
-    case YDLIDAR_G10:
-      name = "G10";
-
-      break;
-
-    case YDLIDAR_S4B:
-      name = "S4B";
-
-      break;
-
-    case YDLIDAR_S2:
-      name = "S2";
-
-      break;
-
-    case YDLIDAR_G6:
-      name = "G6";
-
-      break;
-
-    case YDLIDAR_G2A:
-      name = "G2A";
-
-      break;
-
-    case YDLIDAR_G2B:
-      name = "G2B";
-
-      break;
-
-    case YDLIDAR_G2C:
-      name = "G2C";
-
-      break;
-
-    case YDLIDAR_G4B:
-      name = "G4B";
-
-      break;
-
-    case YDLIDAR_G4C:
-      name = "G4C";
-      break;
-
-    case YDLIDAR_G1:
-      name = "G1";
-
-      break;
-
-    case YDLIDAR_G5:
-      name = "G5";
-      break;
-
-    case YDLIDAR_G7:
-      name = "G7";
-      break;
-
-    case YDLIDAR_TG15:
-      name = "TG15";
-
-      break;
-
-    case YDLIDAR_TG30:
-      name = "TG30";
+enum LidarModelCapability {
+  MODEL_SAMPLE_RATE     = 1 << 0,/**< 支持设置采样率. */
+  MODEL_OCTAVE          = 1 << 1,/**< 距离单位为1/2mm, 采样率编码不同. */
+  MODEL_ZERO_ANGLE      = 1 << 2,/**< 支持零位角度修正. */
+  MODEL_SCAN_FREQUENCY  = 1 << 3,/**< 支持设置扫描频率. */
+  MODEL_INTENSITY       = 1 << 4,/**< 带信号质量. */
+  MODEL_TOF             = 1 << 5,/**< TOF雷达. */
+};
 
-      break;
+/*!
+ * @brief 雷达型号描述
+ */
+struct LidarModelInfo {
+  int model;                  ///< 雷达型号代号, 0为未知型号
+  const char *name;           ///< 型号名称
+  int default_sample_rate;    ///< 默认采样率 [K]
+  float min_scan_frequency;   ///< 最小扫描频率 [Hz]
+  unsigned int caps;          ///< 能力标志, 见LidarModelCapability
+
+  constexpr bool hasSampleRate() const {
+    return (caps & MODEL_SAMPLE_RATE) != 0;
+  }
+  constexpr bool isOctave() const {
+    return (caps & MODEL_OCTAVE) != 0;
+  }
+  constexpr bool hasZeroAngle() const {
+    return (caps & MODEL_ZERO_ANGLE) != 0;
+  }
+  constexpr bool hasScanFrequencyCtrl() const {
+    return (caps & MODEL_SCAN_FREQUENCY) != 0;
+  }
+  constexpr bool hasIntensity() const {
+    return (caps & MODEL_INTENSITY) != 0;
+  }
+  constexpr bool isTOF() const {
+    return (caps & MODEL_TOF) != 0;
+  }
+};
 
-    case YDLIDAR_TG50:
-      name = "TG50";
-      break;
+/*!
+ * @brief 雷达型号表 \n
+ * 新增型号时在表中增加一行, 最后一行为未知型号的默认值
+ */
+constexpr LidarModelInfo LIDAR_MODEL_INFOS[] = {
+  {YDLIDAR_F4,    "F4",    4,  5, MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_T1,    "T1",    4,  5, MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_F2,    "F2",    4,  5, MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_S4,    "S4",    4,  5, 0},
+  {YDLIDAR_G4,    "G4",    9,  5, MODEL_SAMPLE_RATE | MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_X4,    "X4",    5,  5, 0},
+  {YDLIDAR_G4PRO, "G4PRO", 9,  5, MODEL_SAMPLE_RATE | MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_F4PRO, "F4PRO", 4,  5, MODEL_SAMPLE_RATE | MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_R2,    "R2",    5,  5, MODEL_ZERO_ANGLE | MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_G10,   "G10",   10, 5, MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_S4B,   "S4B",   4,  5, MODEL_INTENSITY},
+  {YDLIDAR_S2,    "S2",    3,  5, 0},
+  {YDLIDAR_G6,    "G6",    18, 5, MODEL_SAMPLE_RATE | MODEL_OCTAVE | MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_G2A,   "G2A",   5,  5, MODEL_ZERO_ANGLE | MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_G2B,   "G2B",   5,  5, MODEL_ZERO_ANGLE | MODEL_INTENSITY | MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_G2C,   "G2C",   4,  5, MODEL_ZERO_ANGLE | MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_G4B,   "G4B",   4,  5, MODEL_INTENSITY | MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_G4C,   "G4C",   4,  5, MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_G1,    "G1",    9,  5, MODEL_ZERO_ANGLE | MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_G5,    "G5",    9,  5, MODEL_SAMPLE_RATE | MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_G7,    "G7",    18, 5, MODEL_SAMPLE_RATE | MODEL_OCTAVE | MODEL_SCAN_FREQUENCY},
+  {YDLIDAR_TG15,  "TG15",  20, 3, MODEL_SAMPLE_RATE | MODEL_OCTAVE | MODEL_ZERO_ANGLE | MODEL_SCAN_FREQUENCY | MODEL_TOF},
+  {YDLIDAR_TG30,  "TG30",  20, 3, MODEL_SAMPLE_RATE | MODEL_OCTAVE | MODEL_ZERO_ANGLE | MODEL_SCAN_FREQUENCY | MODEL_TOF},
+  {YDLIDAR_TG50,  "TG50",  20, 3, MODEL_SAMPLE_RATE | MODEL_OCTAVE | MODEL_ZERO_ANGLE | MODEL_SCAN_FREQUENCY | MODEL_TOF},
+  {0,             "unkown", 4, 5, MODEL_SCAN_FREQUENCY},
+};
 
-    default:
-      name = "unkown";
-      break;
-  }
+/*!
+ * @brief 查找雷达型号描述
+ * @param model 雷达型号代号
+ * @param index 开始查找的位置
+ * @return 型号描述, 不支持的型号返回未知型号的默认值
+ */
+constexpr const LidarModelInfo &lidarModelInfo(int model, size_t index = 0) {
+  return (index + 1 == sizeof(LIDAR_MODEL_INFOS) / sizeof(LIDAR_MODEL_INFOS[0]) ||
+          LIDAR_MODEL_INFOS[index].model == model) ? LIDAR_MODEL_INFOS[index] :
+         lidarModelInfo(model, index + 1);
+}
 
-  return name;
+/*!
+ * @brief lidarModelToString
+ * @param model
+ * @return
+ */
+inline std::string lidarModelToString(int model) {
+  return lidarModelInfo(model).name;
 }
 
 /*!
@@ -213,104 +176,7 @@ inline std::string lidarModelToString(int model) {
  * @return
  */
 inline int lidarModelDefaultSampleRate(int model) {
-  int sample_rate = 4;
-
-  switch (model) {
-    case YDLIDAR_F4:
-      break;
-
-    case YDLIDAR_T1:
-      break;
-
-    case YDLIDAR_F2:
-      break;
-
-    case YDLIDAR_S4:
-      break;
-
-    case YDLIDAR_G4:
-      sample_rate = 9;
-      break;
-
-    case YDLIDAR_X4:
-      sample_rate = 5;
-      break;
-
-    case YDLIDAR_G4PRO:
-      sample_rate = 9;
-      break;
-
-    case YDLIDAR_F4PRO:
-      sample_rate = 4;
-      break;
-
-    case YDLIDAR_R2:
-      sample_rate = 5;
-      break;
-
-    case YDLIDAR_G10:
-      sample_rate = 10;
-      break;
-
-    case YDLIDAR_S4B:
-      sample_rate = 4;
-      break;
-
-    case YDLIDAR_S2:
-      sample_rate = 3;
-      break;
-
-    case YDLIDAR_G6:
-      sample_rate = 18;
-      break;
-
-    case YDLIDAR_G2A:
-      sample_rate = 5;
-      break;
-
-    case YDLIDAR_G2B:
-      sample_rate = 5;
-      break;
-
-    case YDLIDAR_G2C:
-      sample_rate = 4;
-      break;
-
-    case YDLIDAR_G4B:
-      break;
-
-    case YDLIDAR_G4C:
-      break;
-
-    case YDLIDAR_G1:
-      sample_rate = 9;
-      break;
-
-    case YDLIDAR_G5:
-      sample_rate = 9;
-      break;
-
-    case YDLIDAR_G7:
-      sample_rate = 18;
-      break;
-
-    case YDLIDAR_TG15:
-      sample_rate = 20;
-      break;
-
-    case YDLIDAR_TG30:
-      sample_rate = 20;
-      break;
-
-    case YDLIDAR_TG50:
-      sample_rate = 20;
-      break;
-
-    default:
-      break;
-  }
-
-  return sample_rate ;
+  return lidarModelInfo(model).default_sample_rate;
 }
 
 /*!
@@ -319,17 +185,7 @@ inline int lidarModelDefaultSampleRate(int model) {
  * @return
  */
 inline bool isOctaveLidar(int model) {
-  bool ret = false;
-
-  if (model == YDLIDAR_G6 ||
-      model == YDLIDAR_G7 ||
-      model == YDLIDAR_TG15 ||
-      model == YDLIDAR_TG30 ||
-      model == YDLIDAR_TG50) {
-    ret = true;
-  }
-
-  return ret;
+  return lidarModelInfo(model).isOctave();
 }
 
 /*!
@@ -338,43 +194,16 @@ inline bool isOctaveLidar(int model) {
  * @return
  */
 inline bool hasSampleRate(int model) {
-  bool ret = false;
-
-  if (model == YDLIDAR_G4 ||
-      model == YDLIDAR_G5 ||
-      model == YDLIDAR_G4PRO ||
-      model == YDLIDAR_F4PRO ||
-      model == YDLIDAR_G6 ||
-      model == YDLIDAR_G7 ||
-      model == YDLIDAR_TG15 ||
-      model == YDLIDAR_TG50 ||
-      model == YDLIDAR_TG30) {
-    ret = true;
-  }
-
-  return ret;
+  return lidarModelInfo(model).hasSampleRate();
 }
+
 /*!
  * @brief hasZeroAngle
  * @param model
  * @return
  */
-
 inline bool hasZeroAngle(int model) {
-  bool ret = false;
-
-  if (model == YDLIDAR_R2 ||
-      model == YDLIDAR_G2A ||
-      model == YDLIDAR_G2B ||
-      model == YDLIDAR_G2C ||
-      model == YDLIDAR_G1 ||
-      model == YDLIDAR_TG15 ||
-      model == YDLIDAR_TG30 ||
-      model == YDLIDAR_TG50) {
-    ret = true;
-  }
-
-  return ret;
+  return lidarModelInfo(model).hasZeroAngle();
 }
 
 /*!
@@ -383,16 +212,7 @@ inline bool hasZeroAngle(int model) {
  * @return
  */
 inline bool hasScanFrequencyCtrl(int model) {
-  bool ret = true;
-
-  if (model == YDLIDAR_S4 ||
-      model == YDLIDAR_S4B ||
-      model == YDLIDAR_S2 ||
-      model == YDLIDAR_X4) {
-    ret = false;
-  }
-
-  return ret;
+  return lidarModelInfo(model).hasScanFrequencyCtrl();
 }
 
 /*!
@@ -401,16 +221,7 @@ inline bool hasScanFrequencyCtrl(int model) {
  * @return
  */
 inline bool isSupportLidar(int model) {
-  bool ret = true;
-
-  if (model < YDLIDAR_F4 || (model > YDLIDAR_G7 &&
-                             model < YDLIDAR_TG15) ||
-      model > YDLIDAR_TG50) {
-    ret = false;
-
-  }
-
-  return ret;
+  return model != 0 && lidarModelInfo(model).model == model;
 }
 
 /*!
@@ -419,15 +230,7 @@ inline bool isSupportLidar(int model) {
  * @return
  */
 inline bool hasIntensity(int model) {
-  bool ret = false;
-
-  if (model == YDLIDAR_G2B ||
-      model == YDLIDAR_G4B ||
-      model == YDLIDAR_S4B) {
-    ret = true;
-  }
-
-  return ret;
+  return lidarModelInfo(model).hasIntensity();
 }
 
 /*!
@@ -436,16 +239,7 @@ inline bool hasIntensity(int model) {
  * @return
  */
 inline bool isSupportMotorCtrl(int model) {
-  bool ret = false;
-
-  if (model == YDLIDAR_X4 ||
-      model == YDLIDAR_S2 ||
-      model == YDLIDAR_S4 ||
-      model == YDLIDAR_S4B) {
-    ret = true;
-
-  }
-
+  UNUSED(model);
   return true;
 }
 
@@ -455,31 +249,17 @@ inline bool isSupportMotorCtrl(int model) {
  * @param frequency
  * @return
  */
-inline bool isSupportScanFrequency(int model, double frequency) {
-  bool ret = false;
-
-  if (model >= YDLIDAR_TG15) {
-    if (3 <= frequency && frequency <= 15.7) {
-      ret = true;
-    }
-  } else {
-    if (5 <= frequency && frequency <= 15.7) {
-      ret = true;
-    }
-  }
-
-  return ret;
+inline bool isSupportScanFrequency(const LidarModelInfo &info,
+                                   double frequency) {
+  return info.min_scan_frequency <= frequency && frequency <= 15.7;
 }
-inline bool isTOFLidarByModel(int model) {
-  bool ret = false;
 
-  if (model == YDLIDAR_TG15 ||
-      model == YDLIDAR_TG30 ||
-      model == YDLIDAR_TG50) {
-    ret = true;
-  }
+inline bool isSupportScanFrequency(int model, double frequency) {
+  return isSupportScanFrequency(lidarModelInfo(model), frequency);
+}
 
-  return ret;
+inline bool isTOFLidarByModel(int model) {
+  return lidarModelInfo(model).isTOF();
 }
 
 inline bool isTOFLidar(int type) {
@@ -492,19 +272,13 @@ inline bool isTOFLidar(int type) {
   return ret;
 }
 
-inline bool isOldVersionTOFLidar(int model, int Major, int Minor) {
-  bool ret = false;
-
-  if (model == YDLIDAR_TG15 ||
-      model == YDLIDAR_TG50 ||
-      model == YDLIDAR_TG30)  {
-    if (Major <= 1 && Minor <= 2) {
-      ret = true;
-    }
-
-  }
+inline bool isOldVersionTOFLidar(const LidarModelInfo &info, int Major,
+                                 int Minor) {
+  return info.isTOF() && Major <= 1 && Minor <= 2;
+}
 
-  return ret;
+inline bool isOldVersionTOFLidar(int model, int Major, int Minor) {
+  return isOldVersionTOFLidar(lidarModelInfo(model), Major, Minor);
 }
 
 inline bool isValidSampleRate(std::map<int, int>  smap) {
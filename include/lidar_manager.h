@@ -0,0 +1,99 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, EAIBOT, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#pragma once
+#include <vector>
+#include "locker.h"
+#include "thread.h"
+
+namespace ydlidar {
+
+class YDlidarDriver;
+
+/*!
+* 多雷达共用的数据解析反应器 \n
+* 一个线程用epoll等待所有已注册雷达的串口数据, 数据到达后调用
+* YDlidarDriver::pollScanData 解析, 完成的一圈数据照常通过 YDlidarDriver::grabScanData 获取.
+* 用 YDlidarDriver::setLidarManager 关联后, ::startScan 自动注册, ::stop 自动注销.
+* @note 仅支持Linux, 其他平台::add返回false, 雷达退回独立的解析线程.
+* 销毁时仍注册的雷达与反应器解除关联, 不再被解析, 应先停止这些雷达的扫描
+*/
+class LidarManager {
+ public:
+  LidarManager();
+  ~LidarManager();
+
+  /*!
+  * @brief 注册一个正在扫描的雷达 \n
+  * 第一次注册时启动反应器线程
+  * @param[in] driver 雷达
+  * @return 成功返回true, 串口不支持等待时返回false
+  */
+  bool add(YDlidarDriver *driver);
+
+  /*!
+  * @brief 注销雷达 \n
+  * 返回后反应器线程不会再访问该雷达
+  * @param[in] driver 雷达
+  */
+  void remove(YDlidarDriver *driver);
+
+  /*!
+  * @brief 已注册的雷达数
+  */
+  size_t size();
+
+ private:
+  /*!
+  * @brief 反应器线程 \n
+  */
+  int runReactor();
+
+  enum {
+    REACTOR_TICK = 100,   /**< 检查接收超时的周期 [ms]. */
+    MAX_EVENTS = 16,      /**< 每次等待最多处理的事件数. */
+  };
+
+  std::vector<YDlidarDriver *> drivers; ///< 已注册的雷达
+  Locker  _lock;                        ///< 保护drivers, 解析期间持有
+  Thread  _thread;                      ///< 反应器线程
+  int     epoll_fd;                     ///< epoll 实例
+  int     wakeup_fd;                    ///< 唤醒反应器线程的eventfd
+  volatile bool running;                ///< 反应器线程运行状态
+
+  // Disable copy constructors
+  LidarManager(const LidarManager &);
+  LidarManager &operator=(const LidarManager &);
+};
+
+}// namespace ydlidar
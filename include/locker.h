@@ -15,6 +15,8 @@
 #include <sys/stat.h>
 #include <errno.h>
 #endif
+#include <stdio.h>
+#include <atomic>
 
 
 class Locker {
@@ -350,4 +352,142 @@ class ScopedLocker {
   Locker &_binded;
 };
 
+/**
+ * Bounded queue of buffers between one producer and one consumer.
+ * The producer fills writeBuffer() and queues it with push(), the consumer
+ * takes the oldest queued buffer with pop() and reads it through readBuffer()
+ * until its next pop(). Buffers are handed over by index, never copied.
+ * depth + 2 buffers are allocated: one being written, one being read and
+ * up to depth queued.
+ */
+template <typename T>
+class BufferQueue {
+ public:
+  explicit BufferQueue(size_t depth = 1)
+    : _depth(depth < 1 ? 1 : depth)
+    , _buffers(new T[_depth + 2])
+    , _queue(new std::atomic<int>[_depth])
+    , _head(0)
+    , _tail(0)
+    , _free(new int[_depth + 2])
+    , _freeHead(0)
+    , _freeTail(0)
+    , _write(0)
+    , _spare(-1)
+    , _read(-1) {
+    for (int i = 1; i < (int)_depth + 2; i++) {
+      _free[i - 1] = i;
+    }
+
+    _freeHead.store(_depth + 1);
+  }
+
+  ~BufferQueue() {
+    delete[] _buffers;
+    delete[] _queue;
+    delete[] _free;
+  }
+
+  size_t capacity() const {
+    return _depth;
+  }
+
+  size_t size() const {
+    return _head.load(std::memory_order_acquire) -
+           _tail.load(std::memory_order_acquire);
+  }
+
+  /// producer: buffer being filled
+  T &writeBuffer() {
+    return _buffers[_write];
+  }
+
+  /// producer: queue the write buffer, false if the queue is full
+  bool push() {
+    size_t head = _head.load(std::memory_order_relaxed);
+
+    if (head - _tail.load(std::memory_order_acquire) >= _depth) {
+      return false;
+    }
+
+    _queue[head % _depth].store(_write, std::memory_order_relaxed);
+    _head.store(head + 1, std::memory_order_release);
+
+    if (_spare >= 0) {
+      _write = _spare;
+      _spare = -1;
+    } else {
+      //never empty here: the consumer returns its buffer before taking the
+      //next one, and the acquire load of _tail above makes that visible
+      _write = _free[_freeTail % (_depth + 2)];
+      _freeTail++;
+    }
+
+    return true;
+  }
 
+  /// producer: discard the oldest queued buffer, false if the consumer took it first
+  bool dropOldest() {
+    size_t tail = _tail.load(std::memory_order_acquire);
+
+    if (tail == _head.load(std::memory_order_relaxed)) {
+      return false;
+    }
+
+    int index = _queue[tail % _depth].load(std::memory_order_relaxed);
+
+    if (!_tail.compare_exchange_strong(tail, tail + 1,
+                                       std::memory_order_acq_rel)) {
+      return false;
+    }
+
+    _spare = index;
+    return true;
+  }
+
+  /// consumer: release the current read buffer and take the oldest queued one
+  bool pop() {
+    if (_read >= 0) {
+      size_t head = _freeHead.load(std::memory_order_relaxed);
+      _free[head % (_depth + 2)] = _read;
+      _freeHead.store(head + 1, std::memory_order_release);
+      _read = -1;
+    }
+
+    size_t tail = _tail.load(std::memory_order_acquire);
+
+    while (tail != _head.load(std::memory_order_acquire)) {
+      int index = _queue[tail % _depth].load(std::memory_order_relaxed);
+
+      if (_tail.compare_exchange_weak(tail, tail + 1,
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+        _read = index;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /// consumer: buffer taken by the last successful pop()
+  T &readBuffer() {
+    return _buffers[_read];
+  }
+
+ private:
+  BufferQueue(const BufferQueue &);
+  BufferQueue &operator=(const BufferQueue &);
+
+  size_t              _depth;
+  T                   *_buffers;
+  std::atomic<int>    *_queue;
+  std::atomic<size_t> _head;
+  std::atomic<size_t> _tail;
+  int                 *_free;
+  std::atomic<size_t> _freeHead;
+  size_t              _freeTail;
+  int                 _write;
+  int                 _spare;
+  int                 _read;
+};
@@ -0,0 +1,175 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, EAIBOT, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include "ydlidar_protocol.h"
+
+class CYdLidar;
+
+namespace ydlidar {
+
+/**
+ * Scan storage owned by CYdLidar and lent out through LaserScanLease.
+ * refs counts the leases that still read scan, the slot is refilled only
+ * once it drops to zero.
+ */
+struct LaserScanSlot {
+  LaserScanSlot() : refs(0) {
+    scan.stamp = 0;
+  }
+
+  LaserScan scan;
+  std::atomic<int> refs;
+
+ private:
+  // Disable copy constructors
+  LaserScanSlot(const LaserScanSlot &);
+  LaserScanSlot &operator=(const LaserScanSlot &);
+};
+
+/**
+ * Read-only view of a scan held inside CYdLidar, see CYdLidar::borrowScan.
+ *
+ * The points stay valid until the last copy of the lease is released or
+ * destroyed; copies share the same scan, so several consumers can read one
+ * revolution without copying it:
+ * @code
+ * LaserScanLease lease;
+ * while (ydlidar::ok()) {
+ *   if (laser.borrowScan(lease, hardError)) {
+ *     for (const LaserPoint *p = lease.begin(); p != lease.end(); ++p) {
+ *       ...
+ *     }
+ *   }
+ * }
+ * @endcode
+ * @note A lease must not outlive the CYdLidar it was borrowed from.
+ */
+class LaserScanLease {
+ public:
+  LaserScanLease() : _slot(NULL) {}
+
+  LaserScanLease(const LaserScanLease &other) : _slot(other._slot) {
+    if (_slot) {
+      _slot->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  LaserScanLease(LaserScanLease &&other) : _slot(other._slot) {
+    other._slot = NULL;
+  }
+
+  LaserScanLease &operator=(const LaserScanLease &other) {
+    LaserScanLease tmp(other);
+    swap(tmp);
+    return *this;
+  }
+
+  LaserScanLease &operator=(LaserScanLease &&other) {
+    LaserScanLease tmp(std::move(other));
+    swap(tmp);
+    return *this;
+  }
+
+  ~LaserScanLease() {
+    release();
+  }
+
+  /** Hand the scan back, the lease is empty afterwards. */
+  void release() {
+    if (_slot) {
+      _slot->refs.fetch_sub(1, std::memory_order_release);
+      _slot = NULL;
+    }
+  }
+
+  void swap(LaserScanLease &other) {
+    LaserScanSlot *slot = _slot;
+    _slot = other._slot;
+    other._slot = slot;
+  }
+
+  /** Returns true if the lease holds a scan. */
+  bool valid() const {
+    return _slot != NULL;
+  }
+
+  /** The whole scan, only valid if valid() is true. */
+  const LaserScan &scan() const {
+    return _slot->scan;
+  }
+
+  //! System time when first range was measured in nanoseconds
+  uint64_t stamp() const {
+    return _slot->scan.stamp;
+  }
+
+  //! Configuration of scan
+  const LaserConfig &config() const {
+    return _slot->scan.config;
+  }
+
+  //! Number of points, 0 for an empty lease
+  size_t size() const {
+    return _slot ? _slot->scan.points.size() : 0;
+  }
+
+  //! Points of the scan, NULL for an empty lease
+  const LaserPoint *data() const {
+    return size() ? &_slot->scan.points[0] : NULL;
+  }
+
+  const LaserPoint *begin() const {
+    return data();
+  }
+
+  const LaserPoint *end() const {
+    return data() + size();
+  }
+
+  const LaserPoint &operator[](size_t index) const {
+    return _slot->scan.points[index];
+  }
+
+ private:
+  friend class ::CYdLidar;
+
+  /** Takes over a reference already counted in slot->refs. */
+  explicit LaserScanLease(LaserScanSlot *slot) : _slot(slot) {}
+
+  LaserScanSlot *_slot;
+};
+
+}
@@ -0,0 +1,154 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, EAIBOT, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#pragma once
+#include <vector>
+#include <utility>
+#include "locker.h"
+#include "ydlidar_driver.h"
+
+namespace ydlidar {
+
+namespace detail {
+/// reserve points in the arrays of the selected ScanFieldID fields
+inline void reserveScan(LaserScan &scan, size_t points,
+                        int fields = SCAN_FIELD_ALL) {
+  (void)fields;
+  scan.points.reserve(points);
+}
+
+inline void reserveScan(LaserScanSoA &scan, size_t points,
+                        int fields = SCAN_FIELD_ALL) {
+  if (fields & SCAN_FIELD_RANGE) {
+    scan.ranges.reserve(points);
+  }
+
+  if (fields & SCAN_FIELD_INTENSITY) {
+    scan.intensities.reserve(points);
+  }
+
+  if (fields & SCAN_FIELD_ANGLE) {
+    scan.angles.reserve(points);
+  }
+
+  if (fields & SCAN_FIELD_CARTESIAN) {
+    scan.x.reserve(points);
+    scan.y.reserve(points);
+  }
+}
+}
+
+/**
+ * Pool of LaserScan or LaserScanSoA objects that keeps their capacity.
+ *
+ * A scan taken with acquire() and handed back with release() keeps its
+ * point storage, so a loop that uses a fresh scan per revolution does not
+ * touch the heap once every pooled scan has been used once:
+ * @code
+ * ScanPool<LaserScan> pool;
+ * while (ydlidar::ok()) {
+ *   LaserScan scan = pool.acquire();
+ *   if (laser.doProcessSimple(scan, hardError)) {
+ *     ...
+ *   }
+ *   pool.release(scan);
+ * }
+ * @endcode
+ * acquire() and release() may be called from different threads.
+ */
+template <typename ScanType>
+class ScanPool {
+ public:
+  /**
+   * @param size    number of scans kept for reuse
+   * @param points  point capacity reserved in each new scan
+   */
+  explicit ScanPool(size_t size = 4,
+                    size_t points = YDlidarDriver::MAX_SCAN_NODES)
+    : _size(size), _points(points) {
+    _free.reserve(size);
+  }
+
+  /**
+   * Take a scan out of the pool, a new one if the pool is empty.
+   * @note The contents of a recycled scan are unspecified,
+   * CYdLidar::doProcessSimple overwrites them.
+   */
+  ScanType acquire() {
+    {
+      ScopedLocker l(_lock);
+
+      if (!_free.empty()) {
+        ScanType scan(std::move(_free.back()));
+        _free.pop_back();
+        return scan;
+      }
+    }
+
+    ScanType scan;
+    detail::reserveScan(scan, _points);
+    return scan;
+  }
+
+  /**
+   * Give the storage of scan back to the pool, scan is left empty.
+   * Scans beyond the pool size are freed.
+   */
+  void release(ScanType &scan) {
+    //freed after the lock is released if the pool is full
+    ScanType released(std::move(scan));
+    ScopedLocker l(_lock);
+
+    if (_free.size() < _size) {
+      _free.push_back(std::move(released));
+    }
+  }
+
+  /** Number of scans ready for reuse. */
+  size_t available() {
+    ScopedLocker l(_lock);
+    return _free.size();
+  }
+
+ private:
+  Locker _lock;
+  std::vector<ScanType> _free;
+  size_t _size;
+  size_t _points;
+
+  // Disable copy constructors
+  ScanPool(const ScanPool &);
+  ScanPool &operator=(const ScanPool &);
+};
+
+}
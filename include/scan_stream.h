@@ -0,0 +1,221 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, EAIBOT, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#pragma once
+
+#if !defined(__cpp_impl_coroutine)
+#error "scan_stream.h requires C++20 coroutines, the C++11 API is CYdLidar.h"
+#endif
+
+#include <coroutine>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include "CYdLidar.h"
+
+namespace ydlidar {
+
+/**
+ * C++20 coroutine view of CYdLidar scans, built on CYdLidar::subscribe.
+ *
+ * A coroutine waiting in next() is suspended rather than blocking a thread,
+ * and is resumed through the executor when the lidar finishes a revolution,
+ * so many lidars and their processing can share a few threads:
+ * @code
+ * // resume on the application's thread pool
+ * ScanStream stream(laser, [&pool](std::coroutine_handle<> h) {
+ *   pool.post(h);
+ * });
+ * laser.initialize();
+ * laser.turnOn();
+ *
+ * task consume(ScanStream &stream) {
+ *   while (true) {
+ *     LaserScanLease scan = co_await stream.next();
+ *
+ *     if (!scan.valid()) {
+ *       break;  // closed
+ *     }
+ *     ...
+ *   }
+ * }
+ * @endcode
+ * Only the latest scan is kept for a coroutine that is not waiting yet,
+ * older ones are dropped. The stream must be created and destroyed while
+ * the lidar is turned off, see CYdLidar::subscribe, and must not outlive it.
+ * Destroyed while scanning, its subscription stays until the lidar is
+ * destroyed.
+ * @note Header only, the SDK itself keeps building as C++11.
+ */
+class ScanStream {
+ private:
+  struct State;
+
+ public:
+  /** Resumes a coroutine, an empty executor resumes it on the lidar thread. */
+  typedef std::function<void(std::coroutine_handle<>)> Executor;
+
+  explicit ScanStream(CYdLidar &lidar, Executor executor = Executor())
+    : _lidar(lidar), _state(std::make_shared<State>()) {
+    _state->executor = std::move(executor);
+    std::shared_ptr<State> state = _state;
+    _id = lidar.subscribe([state](const LaserScanLease & scan) {
+      state->push(scan);
+    });
+
+    if (_id < 0) {
+      _state->close();
+    }
+  }
+
+  ~ScanStream() {
+    close();
+
+    if (_id >= 0 && !_lidar.unsubscribe(_id)) {
+      fprintf(stderr, "[YDLIDAR ERROR] ScanStream destroyed while scanning, "
+              "its subscription is kept until the lidar is destroyed\n");
+      fflush(stderr);
+    }
+  }
+
+  /**
+   * End the stream: a waiting coroutine and every later next() get an empty
+   * lease. Call it after CYdLidar::turnOff, which stops the scans but does
+   * not wake the waiter.
+   */
+  void close() {
+    _state->close();
+  }
+
+  /** Awaitable of next(). */
+  class Awaiter {
+   public:
+    bool await_ready() {
+      std::lock_guard<std::mutex> l(_state->lock);
+      return _state->closed || _state->latest.valid();
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+      std::lock_guard<std::mutex> l(_state->lock);
+
+      // a scan arrived since await_ready
+      if (_state->closed || _state->latest.valid()) {
+        return false;
+      }
+
+      _state->waiter = handle;
+      return true;
+    }
+
+    LaserScanLease await_resume() {
+      std::lock_guard<std::mutex> l(_state->lock);
+      return std::move(_state->latest);
+    }
+
+   private:
+    friend class ScanStream;
+    explicit Awaiter(const std::shared_ptr<State> &state)
+      : _state(state) {}
+
+    std::shared_ptr<State> _state;
+  };
+
+  /**
+   * Wait for the next scan, `co_await stream.next()` yields a
+   * LaserScanLease that is empty once the stream is closed.
+   * @note One coroutine at a time may wait on a stream.
+   */
+  Awaiter next() {
+    return Awaiter(_state);
+  }
+
+ private:
+  /// shared with the subscription, which may outlive the stream
+  struct State {
+    std::mutex lock;
+    LaserScanLease latest;            ///< scan not taken by next() yet
+    std::coroutine_handle<> waiter;   ///< coroutine suspended in next()
+    Executor executor;
+    bool closed = false;
+
+    void push(const LaserScanLease &scan) {
+      std::coroutine_handle<> handle;
+      {
+        std::lock_guard<std::mutex> l(lock);
+
+        if (closed) {
+          return;
+        }
+
+        latest = scan;
+        std::swap(handle, waiter);
+      }
+      resume(handle);
+    }
+
+    void close() {
+      std::coroutine_handle<> handle;
+      {
+        std::lock_guard<std::mutex> l(lock);
+        closed = true;
+        latest.release();
+        std::swap(handle, waiter);
+      }
+      resume(handle);
+    }
+
+    void resume(std::coroutine_handle<> handle) {
+      if (!handle) {
+        return;
+      }
+
+      if (executor) {
+        executor(handle);
+      } else {
+        handle.resume();
+      }
+    }
+  };
+
+  CYdLidar &_lidar;
+  std::shared_ptr<State> _state;
+  int _id;
+
+  // Disable copy constructors
+  ScanStream(const ScanStream &);
+  ScanStream &operator=(const ScanStream &);
+};
+
+}
@@ -49,6 +49,16 @@ typedef enum {
   flowcontrol_hardware
 } flowcontrol_t;
 
+/*!
+* Settings applied by Serial::setLowLatency, combined as bit flags.
+*/
+typedef enum {
+  low_latency_none = 0,
+  low_latency_termios = 0x01,   // VMIN = 1, VTIME = 0
+  low_latency_async = 0x02,     // ASYNC_LOW_LATENCY via TIOCSSERIAL
+  low_latency_usb_timer = 0x04  // USB serial latency_timer set to 1 ms
+} low_latency_t;
+
 /*!
 * Structure for setting the timeout of the serial port, times are
 * in milliseconds.
@@ -174,6 +184,30 @@ class Serial  {
   /*! Return the number of characters in the buffer. */
   size_t available();
 
+  /*! Enable or disable the low latency tty mode.
+  *
+  * Sets VMIN/VTIME to wake on the first byte, ASYNC_LOW_LATENCY on the
+  * driver and the USB serial adapter latency_timer (16 ms by default on
+  * FTDI) to 1 ms. Each setting is tried on its own, previous values are
+  * restored when the mode is disabled or the port is closed. If the port
+  * is not open yet, the mode is applied when it opens.
+  *
+  * \return Bitwise or of the low_latency_t settings that took effect.
+  * \see serial::low_latency_t
+  */
+  int setLowLatency(bool enable);
+
+  /*! Gets the low_latency_t settings currently in effect. */
+  int getLowLatency() const;
+
+  /*! Gets a file descriptor that polls readable when available() would
+  * report new data, for use with an external poll/epoll loop.
+  *
+  * \return The descriptor, -1 if the port is closed or the backend has no
+  * such descriptor (Windows, io_uring).
+  */
+  int getReadFd() const;
+
   /*! Block until there is serial data to read or read_timeout_constant
   * number of milliseconds have elapsed. The return value is true when
   * the function exits with the port in a readable state, false otherwise
@@ -0,0 +1,66 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2020, EAIBOT, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#pragma once
+#include "ydlidar_protocol.h"
+#include <stddef.h>
+
+namespace ydlidar {
+
+/*!
+ * @brief 数据包采样点解码函数 \n
+ * 把校验通过的数据包采样点解码为激光点
+ * @param[in] samples         采样点数据, node_package或node_packages的采样点部分
+ * @param[in] count           采样点数
+ * @param[in] first_angle     第一个采样点角度 [1/64度]
+ * @param[in] interval        采样点角度间隔 [1/64度]
+ * @param[in] correct_table   距离角度修正表, 以distance_q2为索引, TOF雷达不使用
+ * @param[in] package_node    激光点公共信息(同步标志等)
+ * @param[out] nodebuffer     解码后激光点信息
+ */
+typedef void (*PackageDecoder)(const uint8_t *samples, size_t count,
+                               uint16_t first_angle, float interval,
+                               const int16_t *correct_table,
+                               const node_sample &package_node,
+                               node_sample *nodebuffer);
+
+/*!
+ * @brief 选择协议对应的数据包解码函数 \n
+ * 每种协议各有一份模板实例, 解码循环中没有协议分支
+ * @param[in] intensity  是否带信号质量
+ * @param[in] tof        是否TOF雷达
+ * @return 解码函数
+ */
+PackageDecoder selectPackageDecoder(bool intensity, bool tof);
+
+}
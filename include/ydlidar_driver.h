@@ -55,6 +55,7 @@
 #include "locker.h"
 #include "thread.h"
 #include "ydlidar_protocol.h"
+#include "ydlidar_decoder.h"
 #include "help_info.h"
 
 #if !defined(__cplusplus)
@@ -69,6 +70,12 @@ using namespace serial;
 
 namespace ydlidar {
 
+class LidarManager;
+
+namespace test {
+struct Access;
+}
+
 /*!
 * Class that provides a lidar interface.
 */
@@ -121,6 +128,48 @@ class YDlidarDriver {
   * @see DriverInterface::setPointTime and DriverInterface::getPointTime
   */
   PropertyBuilderByName(uint32_t, PointTime,private);
+  /**
+  * @brief Set and Get scan queue depth.
+  * @note Number of finished scans kept for ::grabScanData.\n
+  * With depth 1 and [QUEUE_DROP_OLDEST](\ref ScanQueuePolicyID::QUEUE_DROP_OLDEST)
+  * only the latest scan is returned. Takes effect on the next ::startScan.
+  * @see DriverInterface::setScanQueueSize and DriverInterface::getScanQueueSize
+  */
+  PropertyBuilderByName(int, ScanQueueSize, private);
+  /**
+  * @brief Set and Get scan queue overflow policy.
+  * @see [ScanQueuePolicyID](\ref ScanQueuePolicyID)
+  * @see DriverInterface::setScanQueuePolicy and DriverInterface::getScanQueuePolicy
+  */
+  PropertyBuilderByName(int, ScanQueuePolicy, private);
+  /**
+  * @brief Set and Get low latency serial mode.
+  * @note Sets VMIN/VTIME, ASYNC_LOW_LATENCY and the USB serial latency_timer
+  * when the port is opened, restored on ::disconnect. Takes effect on the
+  * next ::connect.
+  * @see serial::Serial::setLowLatency
+  * @see DriverInterface::setLowLatency and DriverInterface::getLowLatency
+  */
+  PropertyBuilderByName(bool, LowLatency, private);
+  /**
+  * @brief Set and Get target scan thread wakeups per second.
+  * @note 0 (default) wakes on every package. A positive value puts the scan
+  * thread on a fixed cadence: it sleeps between wakeups and decodes all
+  * buffered bytes at once. The interval is capped to the byte time of
+  * MAX_RECV_BUFFER_SIZE bytes so no data is lost at low rates. Not used when
+  * the driver is driven by a LidarManager.
+  * @see DriverInterface::setWakeupRate and DriverInterface::getWakeupRate
+  */
+  PropertyBuilderByName(int, WakeupRate, private);
+  /**
+  * @brief Set and Get ascending scan assembly.
+  * @note When enabled, nodes before the 360 to 0 degree wrap are moved to
+  * the end of the scan as it is assembled, so ::grabScanData returns scans
+  * already in ascending angle order, as ::ascendScanData would. No
+  * allocation or full copy per scan. Takes effect immediately.
+  * @see DriverInterface::setAscendScan and DriverInterface::getAscendScan
+  */
+  PropertyBuilderByName(bool, AscendScan, private);
   /*!
   * A constructor.
   * A more elaborate description of the constructor.
@@ -242,11 +291,28 @@ class YDlidarDriver {
   * @brief 获取激光数据 \n
   * @param[in] nodebuffer 激光点信息
   * @param[in] count      一圈激光点数
+  * @param[out] info      一圈激光数据的公共信息
   * @param[in] timeout    超时时间
   * @return 返回执行结果
   * @retval RESULT_OK       获取成功
   * @retval RESULT_FAILE    获取失败
-  * @note 获取之前，必须使用::startScan函数开启扫描
+  * @note 获取之前，必须使用::startScan函数开启扫描 \n
+  * 按扫描队列顺序返回一圈数据, 不能在多个线程中同时调用
+  */
+  result_t grabScanData(node_sample *nodebuffer, size_t &count,
+                        scan_info &info, uint32_t timeout = DEFAULT_TIMEOUT);
+
+  /*!
+  * @brief 获取激光数据 \n
+  * 兼容旧接口, 一圈的公共信息保存在第一个激光点中
+  * @param[in] nodebuffer 激光点信息
+  * @param[in] count      一圈激光点数
+  * @param[in] timeout    超时时间
+  * @return 返回执行结果
+  * @retval RESULT_OK       获取成功
+  * @retval RESULT_FAILE    获取失败
+  * @note 获取之前，必须使用::startScan函数开启扫描 \n
+  * 只返回最新的一圈数据, 不能在多个线程中同时调用
   */
   result_t grabScanData(node_info *nodebuffer, size_t &count,
                         uint32_t timeout = DEFAULT_TIMEOUT) ;
@@ -254,7 +320,7 @@ class YDlidarDriver {
 
   /*!
   * @brief 补偿激光角度 \n
-  * 把角度限制在0到360度之间
+  * 把角度限制在0到360度之间, 并把一圈数据旋转为升序, 不分配内存
   * @param[in] nodebuffer 激光点信息
   * @param[in] count      一圈激光点数
   * @return 返回执行结果
@@ -264,6 +330,56 @@ class YDlidarDriver {
   */
   result_t ascendScanData(node_info *nodebuffer, size_t count);
 
+  /*!
+  * @brief 获取扫描队列溢出次数 \n
+  * 队列满时每丢弃一圈数据(或阻塞解析线程一次)计数一次
+  * @return 当前扫描队列的溢出次数
+  */
+  uint32_t getScanQueueOverflowCount() const;
+
+  /*!
+  * @brief 设置共享的数据解析反应器 \n
+  * 设置后::startScan不再创建独立的解析线程, 而是把雷达注册到manager的反应器线程,
+  * 多个雷达共用一个线程解析数据
+  * @param[in] manager 反应器, NULL 使用独立的解析线程
+  * @note 停止扫描后再执行当前操作. 反应器模式下不自动重连,
+  * [QUEUE_BLOCK](\ref ScanQueuePolicyID::QUEUE_BLOCK)按
+  * [QUEUE_DROP_NEWEST](\ref ScanQueuePolicyID::QUEUE_DROP_NEWEST)处理
+  */
+  void setLidarManager(LidarManager *manager);
+
+  /*!
+  * @brief 一圈数据进入扫描队列后的回调
+  * @param[in] context ::setScanPublishedCallback 设置的参数
+  */
+  typedef void (*ScanPublishedCallback)(void *context);
+
+  /*!
+  * @brief 设置一圈数据完成后的回调 \n
+  * 回调在解析线程(或反应器线程)中执行, 这圈数据已在扫描队列中,
+  * 可以直接用::grabScanData取出. 队列满而丢弃新数据时不回调
+  * @param[in] callback 回调, NULL 不回调
+  * @param[in] context  传给回调的参数
+  * @note 停止扫描后再执行当前操作, 回调中不能停止扫描
+  */
+  void setScanPublishedCallback(ScanPublishedCallback callback, void *context);
+
+  /*!
+  * @brief 非阻塞地读取并解析串口中已有的数据 \n
+  * 由::LidarManager反应器线程调用, 完成的一圈数据放入扫描队列
+  * @param[in] hangup 串口已挂起或出错(EPOLLHUP/EPOLLERR), 解析完已有数据后停止扫描
+  * @return 返回执行结果
+  * @retval RESULT_OK       成功
+  * @retval RESULT_FAIL     串口错误, 挂起或接收超时, 扫描已停止
+  */
+  result_t pollScanData(bool hangup = false);
+
+  /*!
+  * @brief 获取串口可读事件的文件描述符 \n
+  * @return 文件描述符, 不支持时返回-1
+  */
+  int getReadFd() const;
+
   /*!
   * @brief 重置激光雷达 \n
   * @param[in] timeout      超时时间
@@ -427,31 +543,115 @@ class YDlidarDriver {
    * @return
    */
   result_t waitDevicePackage(uint32_t timeout = DEFAULT_TIMEOUT);
+  /*!
+  * @brief 解析缓冲区中的激光数据包 \n
+  * 在连续的缓冲区中查找完整的数据包, 校验通过后一次性解析包内全部激光点
+  * @param[in] data        数据缓冲区
+  * @param[in] size        缓冲区数据大小
+  * @param[out] used       已处理(可丢弃)的数据大小
+  * @param[out] remain     凑齐下一个完整数据包还需要的数据大小
+  * @param[out] nodebuffer 解包后激光点信息, 至少容纳 PackageSampleMaxLngth 个点
+  * @param[out] count      解包后激光点数
+  * @param[out] info       数据包中的转速和调试信息
+  * @return 返回执行结果
+  * @retval RESULT_OK       解析到一个完整数据包
+  * @retval RESULT_FAIL     缓冲区中没有完整数据包
+  */
+  result_t parsePackage(const uint8_t *data, size_t size, size_t &used,
+                        size_t &remain, node_sample *nodebuffer, size_t &count,
+                        scan_info &info);
+
+  /*!
+  * @brief 计算数据包校验和 \n
+  * @param[in] data  数据包起始地址, 需包含完整的数据包
+  * @return 校验和, 与包头中的checkSum相等时校验通过
+  */
+  uint16_t packageCheckSum(const uint8_t *data);
+
+  /*!
+  * @brief 检查候选帧头处是否为完整且校验通过的数据包 \n
+  * @param[in] data     候选帧头起始地址
+  * @param[in] size     候选帧头之后的数据大小
+  * @param[out] remain  数据包不完整时, 凑齐数据包还需要的数据大小, 否则为0
+  * @return 数据包是否有效
+  */
+  bool isPackageValid(const uint8_t *data, size_t size, size_t &remain);
+
   /*!
   * @brief 解包激光数据 \n
-  * @param[in] node 解包后激光点信息
+  * 每次解析一个完整数据包的全部激光点
+  * @param[in] nodebuffer 解包后激光点信息, 至少容纳 PackageSampleMaxLngth 个点
+  * @param[in] count      解包后激光点数
+  * @param[out] info       数据包中的转速和调试信息
   * @param[in] timeout     超时时间
   */
-  result_t waitPackage(node_info *node, uint32_t timeout = DEFAULT_TIMEOUT);
+  result_t waitPackage(node_sample *nodebuffer, size_t &count,
+                       scan_info &info, uint32_t timeout = DEFAULT_TIMEOUT);
 
   /*!
   * @brief 发送数据到雷达 \n
   * @param[in] nodebuffer 激光信息指针
   * @param[in] count      激光点数大小
+  * @param[out] info       收到的转速, 调试信息和零位包时间戳
   * @param[in] timeout      超时时间
   * @return 返回执行结果
   * @retval RESULT_OK       成功
   * @retval RESULT_TIMEOUT  等待超时
   * @retval RESULT_FAILE    失败
   */
-  result_t waitScanData(node_info *nodebuffer, size_t &count,
-                        uint32_t timeout = DEFAULT_TIMEOUT);
+  result_t waitScanData(node_sample *nodebuffer, size_t &count,
+                        scan_info &info, uint32_t timeout = DEFAULT_TIMEOUT);
 
   /*!
   * @brief 激光数据解析线程 \n
   */
   int cacheScanData();
 
+  /*!
+  * @brief 把解包后的激光点拼接成一圈数据 \n
+  * 收到零位包时把上一圈数据放入扫描队列
+  * @param[in] nodes  激光点信息
+  * @param[in] count  激光点数
+  * @param[in] info   转速, 调试信息和零位包时间戳
+  */
+  void cacheScanNodes(const node_sample *nodes, size_t count,
+                      const scan_info &info);
+
+  /*!
+  * @brief 开始拼接新的一圈数据 \n
+  * 在解析线程或反应器开始解析前调用
+  */
+  void resetScanCache();
+
+  /*!
+  * @brief 计算零位包的传输延时 \n
+  * 根据接收缓冲区中零位包之后的数据量估算
+  * @return 延时 [ns]
+  */
+  uint64_t syncPackageDelay();
+
+  /*!
+  * @brief 批量读取模式下等待下一个唤醒周期 \n
+  * 周期为1000 / ::WakeupRate ms, 不超过接收缓冲区填满所需的时间
+  */
+  void waitWakeupInterval();
+
+  /*!
+  * @brief 把一圈数据放入扫描队列 \n
+  * 队列满时按::ScanQueuePolicy处理
+  */
+  void publishScanData();
+
+  /*!
+  * @brief 从扫描队列取出一圈数据 \n
+  * @param[in] timeout      超时时间
+  * @return 返回执行结果
+  * @retval RESULT_OK       成功, 数据在scan_queue->readBuffer()中
+  * @retval RESULT_TIMEOUT  等待超时
+  * @retval RESULT_FAILE    失败
+  */
+  result_t waitScanBuffer(uint32_t timeout);
+
   /*!
   * @brief 发送数据到雷达 \n
   * @param[in] cmd 	 命名码
@@ -517,6 +717,18 @@ class YDlidarDriver {
   */
   void checkTransDelay();
 
+  /*!
+  * @brief 更新距离角度修正表 \n
+  * 三角雷达角度修正只与距离有关, 按雷达型号预先计算每个距离的修正值
+  * @note 雷达型号变化时重新计算, TOF雷达不需要修正表
+  */
+  void updateAngleCorrectTable();
+
+  /*!
+  * @brief 根据信号质量和雷达类型选择数据包解码函数 \n
+  */
+  void updatePackageDecoder();
+
   /*!
   * @brief 关闭数据获取通道 \n
   */
@@ -554,17 +766,27 @@ class YDlidarDriver {
     DEFAULT_TIMEOUT = 2000,    /**< 默认超时时间. */
     DEFAULT_HEART_BEAT = 1000, /**< 默认检测掉电功能时间. */
     MAX_SCAN_NODES = 3600,	   /**< 最大扫描点数. */
+    MAX_RECV_BUFFER_SIZE = 4096, /**< 数据包接收缓冲区大小. */
     DEFAULT_TIMEOUT_COUNT = 1,
   };
 
-  node_info      *scan_node_buf;    ///< 激光点信息
-  size_t         scan_node_count;   ///< 激光点数
+  /// 一圈激光数据
+  struct ScanBuffer {
+    node_sample  nodes[MAX_SCAN_NODES]; ///< 激光点信息
+    size_t       count;                 ///< 激光点数
+    scan_info    info;                  ///< 一圈激光数据的公共信息
+  };
+
+  BufferQueue<ScanBuffer> *scan_queue;  ///< 解析线程和::grabScanData之间的扫描队列
+  std::atomic<uint32_t> scan_queue_overflow; ///< 扫描队列溢出次数
+  Event          _queueEvent;       ///< 扫描队列空位事件
   Event          _dataEvent;        ///< 数据同步事件
   Locker         _lock;				///< 线程锁
   Locker         _serial_lock;		///< 串口锁
   Thread 	     _thread;		   ///< 线程id
 
  private:
+  friend struct test::Access;        ///< 无硬件时向扫描队列写入数据, 见tests/
   int PackageSampleBytes;            ///< 一个包包含的激光点数
   serial::Serial *_serial;			///< 串口
   bool m_intensities;				///< 信号质量状体
@@ -573,27 +795,19 @@ class YDlidarDriver {
   uint32_t trans_delay;				///< 串口传输一个byte时间
   int m_sampling_rate;              ///< 采样频率
   int model;                        ///< 雷达型号
+  const LidarModelInfo *model_info; ///< 雷达型号描述, 在::getDeviceInfo中更新
   int sample_rate;                  ///<
 
-  node_package package;             ///< 带信号质量协议包
-  node_packages packages;           ///< 不带信好质量协议包
-
-  uint16_t package_Sample_Index;    ///< 包采样点索引
-  float IntervalSampleAngle;
   float IntervalSampleAngle_LastPackage;
-  uint16_t FirstSampleAngle;        ///< 起始采样角
-  uint16_t LastSampleAngle;         ///< 结束采样角
-  uint16_t CheckSum;                ///< 校验和
+  int16_t *angleCorrectTable;       ///< 距离角度修正表, 以distance_q2为索引
+  PackageDecoder package_decoder;   ///< 当前协议的数据包解码函数
+  int angleCorrectScale;            ///< 修正表对应的距离缩放系数
   uint8_t scan_frequence;           ///< 协议中雷达转速
 
-  uint16_t CheckSumCal;
-  uint16_t SampleNumlAndCTCal;
-  uint16_t LastSampleAngleCal;
-  bool CheckSumResult;
-  uint16_t Valu8Tou16;
-
   std::string serial_port;///< 雷达端口
   uint8_t *globalRecvBuffer;
+  size_t   globalRecvPos;           ///< 接收缓冲区中已解析的位置
+  size_t   globalRecvSize;          ///< 接收缓冲区中的数据大小
   int retryCount;
   bool has_device_header;
   uint8_t last_device_byte;
@@ -613,6 +827,19 @@ class YDlidarDriver {
   int package_index;
   bool has_package_error;
 
+  ScanBuffer *cache_scan;           ///< 正在拼接的一圈数据
+  size_t cache_count;               ///< 正在拼接的激光点数
+  LidarManager *lidar_manager;      ///< 共享的数据解析反应器
+  bool lidar_managed;               ///< 是否已注册到反应器
+  uint32_t last_data_time;          ///< 反应器模式下最后收到数据的时间 [ms]
+  bool wait_scan_start;             ///< 丢弃第一个零位包及之前的数据
+  node_sample *ascend_head;         ///< 升序拼接时360到0度跳变之前的激光点
+  size_t ascend_head_count;         ///< ascend_head中的激光点数
+  int ascend_last_angle;            ///< 升序拼接时上一个有效激光点的角度 [1/64度], -1 无
+  uint32_t last_wakeup_time;        ///< 批量读取模式下上次唤醒的时间 [ms]
+  ScanPublishedCallback scan_published;  ///< 一圈数据完成后的回调
+  void *scan_published_context;     ///< 传给scan_published的参数
+
 };
 
 }// namespace ydlidar
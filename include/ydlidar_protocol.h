@@ -33,6 +33,7 @@
 *********************************************************************/
 #pragma once
 #include "v8stdint.h"
+#include "aligned_allocator.h"
 #include <vector>
 
 #define PropertyBuilderByName(type, name, access_permission)\
@@ -128,6 +129,41 @@ typedef enum {
   TYPE_Tail,
 } LidarTypeID;
 
+//! 扫描队列满时的处理策略
+typedef enum {
+  QUEUE_DROP_OLDEST = 0,//!< 丢弃队列中最旧的一圈数据
+  QUEUE_DROP_NEWEST = 1,//!< 丢弃刚解析完成的一圈数据
+  QUEUE_BLOCK = 2,//!< 阻塞解析线程直到队列有空位
+  QUEUE_Tail,
+} ScanQueuePolicyID;
+
+//! 扫描回调的执行线程, 见CYdLidar::subscribe
+typedef enum {
+  CALLBACK_INLINE = 0,//!< 在解析线程(或反应器线程)中直接调用
+  CALLBACK_WORKER = 1,//!< 在CYdLidar的回调线程池中调用
+  CALLBACK_Tail,
+} ScanCallbackExecutorID;
+
+//! 固定角分辨率下落入同一角度格的多个点的处理方式
+typedef enum {
+  BIN_NONE = 0,//!< 不分格, 按接收顺序输出
+  BIN_NEAREST = 1,//!< 取角度最接近格中心的点
+  BIN_MIN_RANGE = 2,//!< 取距离最近的点
+  BIN_MAX_INTENSITY = 3,//!< 取信号强度最大的点
+  BIN_MEAN = 4,//!< 取所有有效点的平均值
+  BIN_Tail,
+} BinReductionID;
+
+//! LaserScanSoA中输出的字段, 可以按位组合
+typedef enum {
+  SCAN_FIELD_RANGE = 0x01,//!< 距离
+  SCAN_FIELD_INTENSITY = 0x02,//!< 信号强度
+  SCAN_FIELD_ANGLE = 0x04,//!< 角度
+  SCAN_FIELD_POLAR = 0x07,//!< 距离, 信号强度和角度
+  SCAN_FIELD_CARTESIAN = 0x08,//!< 直角坐标x, y
+  SCAN_FIELD_ALL = 0x0F,
+} ScanFieldID;
+
 #if defined(_WIN32)
 #pragma pack(1)
 #endif
@@ -143,6 +179,23 @@ struct node_info {
   uint8_t    index;
 } __attribute__((packed)) ;
 
+//! 紧凑的激光点信息, 一圈数据的公共信息见::scan_info
+struct node_sample {
+  uint16_t   sync_quality;//!信号质量
+  uint16_t   angle_q6_checkbit; //!测距点角度
+  uint16_t   distance_q2; //! 当前测距点距离
+  uint8_t    sync_flag;  //sync flag
+  uint8_t    reserved;
+};
+
+//! 一圈激光数据的公共信息
+struct scan_info {
+  uint64_t   stamp; //! 时间戳
+  uint8_t    scan_frequence;//! 特定版本此值才有效,无效值是0
+  uint8_t    debug_info[12];
+  uint16_t   debug_mask;//! debug_info中有效的索引, 第i位对应debug_info[i]
+};
+
 struct PackageNode {
   uint8_t PakageSampleQuality;
   uint16_t PakageSampleDistance;
@@ -239,12 +292,6 @@ struct LaserPoint {
   float range;
   //! lidar intensity
   float intensity;
-  LaserPoint &operator = (const LaserPoint &data) {
-    this->angle = data.angle;
-    this->range = data.range;
-    this->intensity = data.intensity;
-    return *this;
-  }
 };
 
 struct LaserDebug {
@@ -275,16 +322,6 @@ struct LaserConfig {
   float min_range;
   //! Maximum range [m]
   float max_range;
-  LaserConfig &operator = (const LaserConfig &data) {
-    min_angle = data.min_angle;
-    max_angle = data.max_angle;
-    angle_increment = data.angle_increment;
-    time_increment = data.time_increment;
-    scan_time = data.scan_time;
-    min_range = data.min_range;
-    max_range = data.max_range;
-    return *this;
-  }
 };
 
 
@@ -313,11 +350,22 @@ struct LaserScan {
   std::vector<LaserPoint> points;
   //! Configuration of scan
   LaserConfig config;
-  LaserScan &operator = (const LaserScan &data) {
-    this->points = data.points;
-    this->stamp = data.stamp;
-    this->config = data.config;
-    return *this;
-  }
+};
 
+//! Structure-of-arrays laser scan, see CYdLidar::setScanFields
+struct LaserScanSoA {
+  //! System time when first range was measured in nanoseconds
+  uint64_t stamp;
+  //! Array of lidar ranges [m], empty unless SCAN_FIELD_RANGE is selected
+  std::vector<float, AlignedAllocator<float> > ranges;
+  //! Array of lidar intensities, empty unless SCAN_FIELD_INTENSITY is selected
+  std::vector<float, AlignedAllocator<float> > intensities;
+  //! Array of lidar angles [rad], empty unless SCAN_FIELD_ANGLE is selected
+  std::vector<float, AlignedAllocator<float> > angles;
+  //! Array of x coordinates [m], empty unless SCAN_FIELD_CARTESIAN is selected
+  std::vector<float, AlignedAllocator<float> > x;
+  //! Array of y coordinates [m], empty unless SCAN_FIELD_CARTESIAN is selected
+  std::vector<float, AlignedAllocator<float> > y;
+  //! Configuration of scan
+  LaserConfig config;
 };
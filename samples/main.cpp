@@ -225,9 +225,11 @@ int main(int argc, char *argv[]) {
     ret = laser.turnOn();
   }
 
+  //reused every revolution, its storage is allocated only once
+  LaserScan scan;
+
   while (ret && ydlidar::ok()) {
     bool hardError;
-    LaserScan scan;
 
     if (laser.doProcessSimple(scan, hardError)) {
       fprintf(stdout, "Scan received[%llu]: %u ranges is [%f]Hz\n",
@@ -32,10 +32,13 @@
 *  POSSIBILITY OF SUCH DAMAGE.
 *********************************************************************/
 #include "CYdLidar.h"
+#include "scan_pool.h"
 #include "common.h"
 #include <map>
 #include <angles.h>
 #include <numeric>
+#include <algorithm>
+#include "ydlidar_cartesian.h"
 
 using namespace std;
 using namespace ydlidar;
@@ -46,7 +49,7 @@ using namespace angles;
 /*-------------------------------------------------------------
 						Constructor
 -------------------------------------------------------------*/
-CYdLidar::CYdLidar(): lidarPtr(nullptr) {
+CYdLidar::CYdLidar(): lidarPtr(nullptr), lidarManager(nullptr) {
   m_SerialPort        = "";
   m_SerialBaudrate    = 230400;
   m_FixedResolution   = true;
@@ -67,6 +70,14 @@ CYdLidar::CYdLidar(): lidarPtr(nullptr) {
   m_FixedSize         = 720;
   frequencyOffset     = 0.4;
   m_AbnormalCheckCount  = 4;
+  m_ScanQueueSize     = 1;
+  m_ScanQueuePolicy   = QUEUE_DROP_OLDEST;
+  m_LowLatency        = false;
+  m_WakeupRate        = 0;
+  m_CallbackThreads   = 1;
+  m_FixedResolutionReduction = BIN_NONE;
+  m_MaxInterpolationGap = 0;
+  m_ScanFields        = SCAN_FIELD_POLAR;
   Major               = 0;
   Minjor              = 0;
   m_IgnoreArray.clear();
@@ -74,9 +85,26 @@ CYdLidar::CYdLidar(): lidarPtr(nullptr) {
   m_OffsetTime        = 0.0;
   m_AngleOffset       = 0.0;
   lidar_model = YDLIDAR_G2B;
+  lidar_model_info = &lidarModelInfo(lidar_model);
   last_node_time = getTime();
-  global_nodes = new node_info[YDlidarDriver::MAX_SCAN_NODES];
+  global_nodes = new node_sample[YDlidarDriver::MAX_SCAN_NODES];
+  memset(&global_scan_info, 0, sizeof(global_scan_info));
   m_ParseSuccess = false;
+  unit_cached = false;
+  angle_table_offset = 0.f;
+  angle_table_reversion = false;
+  angle_table_inverted = false;
+  angle_table_min = 0.f;
+  angle_table_max = 0.f;
+  angle_window_full = true;
+  unit_min_angle = 0.f;
+  unit_increment = 0.f;
+  next_subscriber_id = 0;
+  callback_head = 0;
+  callback_count = 0;
+  callback_active = 0;
+  callback_running = false;
+  callback_drops = 0;
 }
 
 /*-------------------------------------------------------------
@@ -98,6 +126,8 @@ void CYdLidar::disconnecting() {
     lidarPtr = nullptr;
   }
 
+  stopCallbackWorkers();
+
   isScanning = false;
 }
 
@@ -122,6 +152,22 @@ std::string CYdLidar::getSerialNumber() const {
   return m_lidarSerialNum;
 }
 
+uint32_t CYdLidar::getScanQueueOverflowCount() const {
+  if (!lidarPtr) {
+    return 0;
+  }
+
+  return lidarPtr->getScanQueueOverflowCount();
+}
+
+void CYdLidar::setLidarManager(LidarManager *manager) {
+  lidarManager = manager;
+
+  if (lidarPtr) {
+    lidarPtr->setLidarManager(manager);
+  }
+}
+
 bool CYdLidar::isRangeValid(double reading) const {
   if (reading >= m_MinRange && reading <= m_MaxRange) {
     return true;
@@ -131,17 +177,431 @@ bool CYdLidar::isRangeValid(double reading) const {
 }
 
 bool CYdLidar::isRangeIgnore(double angle) const {
-  bool ret = false;
+  if (ignore_intervals.empty()) {
+    return false;
+  }
+
+  int bucket = static_cast<int>((angle + M_PI) * IGNORE_MASK_BUCKETS /
+                                (2 * M_PI));
+
+  if (bucket < 0) {
+    bucket = 0;
+  } else if (bucket >= IGNORE_MASK_BUCKETS) {
+    bucket = IGNORE_MASK_BUCKETS - 1;
+  }
+
+  size_t j = ignore_buckets[bucket];
+
+  while (j < ignore_intervals.size() && ignore_intervals[j].second < angle) {
+    j++;
+  }
+
+  return j < ignore_intervals.size() && ignore_intervals[j].first <= angle;
+}
+
+void CYdLidar::updateIgnoreMask() {
+  if (m_IgnoreArray == ignore_mask_source) {
+    return;
+  }
+
+  ignore_mask_source = m_IgnoreArray;
+  ignore_intervals.clear();
+  ignore_buckets.clear();
+
+  std::vector<std::pair<double, double> > intervals;
+
+  for (size_t j = 0; j + 1 < m_IgnoreArray.size(); j = j + 2) {
+    double min = angles::from_degrees(m_IgnoreArray[j]);
+    double max = angles::from_degrees(m_IgnoreArray[j + 1]);
+
+    if (min <= max) {
+      intervals.push_back(std::make_pair(min, max));
+    }
+  }
+
+  if (intervals.empty()) {
+    return;
+  }
+
+  std::sort(intervals.begin(), intervals.end());
+
+  for (size_t j = 0; j < intervals.size(); j++) {
+    if (!ignore_intervals.empty() &&
+        intervals[j].first <= ignore_intervals.back().second) {
+      ignore_intervals.back().second = std::max(ignore_intervals.back().second,
+                                       intervals[j].second);
+    } else {
+      ignore_intervals.push_back(intervals[j]);
+    }
+  }
+
+  ignore_buckets.resize(IGNORE_MASK_BUCKETS);
+  size_t first = 0;
+
+  for (int i = 0; i < IGNORE_MASK_BUCKETS; i++) {
+    //start one bucket early so rounding at bucket edges never skips an interval
+    double bucket_min = -M_PI + 2 * M_PI * (i - 1) / IGNORE_MASK_BUCKETS;
+
+    while (first < ignore_intervals.size() &&
+           ignore_intervals[first].second < bucket_min) {
+      first++;
+    }
+
+    ignore_buckets[i] = static_cast<uint16_t>(first);
+  }
+
+  //the first bucket also takes angles below -PI
+  ignore_buckets[0] = 0;
+}
+
+void CYdLidar::updateAngleTable() {
+  if (m_MaxAngle < m_MinAngle) {
+    float temp = m_MinAngle;
+    m_MinAngle = m_MaxAngle;
+    m_MaxAngle = temp;
+  }
+
+  if (!angle_table.empty() && angle_table_offset == m_AngleOffset &&
+      angle_table_reversion == m_Reversion &&
+      angle_table_inverted == m_Inverted &&
+      angle_table_min == m_MinAngle && angle_table_max == m_MaxAngle &&
+      m_IgnoreArray == ignore_mask_source) {
+    return;
+  }
+
+  updateIgnoreMask();
+  angle_table_offset = m_AngleOffset;
+  angle_table_reversion = m_Reversion;
+  angle_table_inverted = m_Inverted;
+  angle_table_min = m_MinAngle;
+  angle_table_max = m_MaxAngle;
+  angle_table.resize(360 * 64 + 1);
+  point_angles.resize(YDlidarDriver::MAX_SCAN_NODES);
+  point_ranges.resize(YDlidarDriver::MAX_SCAN_NODES);
+  point_intensities.resize(YDlidarDriver::MAX_SCAN_NODES);
+  point_inside.resize(YDlidarDriver::MAX_SCAN_NODES);
+
+  //distance_q2 units per meter
+  float range_unit = 4000.f;
+
+  if (isTOFLidar(m_LidarType)) {
+    range_unit = isOldVersionTOFLidar(*lidar_model_info, Major,
+                                      Minjor) ? 2000.f : 1000.f;
+  } else if (lidar_model_info->isOctave()) {
+    range_unit = 2000.f;
+  }
+
+  float range_scale = 1.f / range_unit;
+  float min_angle = angles::from_degrees(m_MinAngle);
+  float max_angle = angles::from_degrees(m_MaxAngle);
+  angle_window_full = true;
+
+  for (size_t i = 0; i < angle_table.size(); i++) {
+    float angle = static_cast<float>(i / 64.0f) + m_AngleOffset;
+    angle = angles::from_degrees(angle);
+
+    //Rotate 180 degrees or not
+    if (m_Reversion) {
+      angle = angle + M_PI;
+    }
+
+    //Is it counter clockwise
+    if (m_Inverted) {
+      angle = 2 * M_PI - angle;
+    }
+
+    angle = angles::normalize_angle(angle);
+    angle_table[i].angle = angle;
+    angle_table[i].scale = isRangeIgnore(angle) ? 0.f : range_scale;
+    angle_table[i].inside = angle >= min_angle && angle <= max_angle;
+    angle_window_full = angle_window_full && angle_table[i].inside;
+  }
+}
+
+
+void CYdLidar::resetScanBins(int size) {
+  ScanBin bin;
+  bin.samples = 0;
+  bin.valid = 0;
+  bin.weight = 0.0;
+  bin.range = 0.0;
+  bin.intensity = 0.0;
+  scan_bins.assign(size, bin);
+}
+
+void CYdLidar::reduceScanBin(int index, float weight, float range,
+                             float intensity) {
+  ScanBin &bin = scan_bins[index];
+  bin.samples++;
+
+  //invalid samples only mark the bin as seen
+  if (range <= 0.0) {
+    return;
+  }
+
+  bool replace = bin.valid == 0;
+
+  switch (m_FixedResolutionReduction) {
+    case BIN_NEAREST:
+      if (replace || weight < bin.weight) {
+        bin.range = range;
+        bin.intensity = intensity;
+        bin.weight = weight;
+      }
+
+      break;
+
+    case BIN_MIN_RANGE:
+      if (replace || range < bin.range) {
+        bin.range = range;
+        bin.intensity = intensity;
+      }
+
+      break;
+
+    case BIN_MAX_INTENSITY:
+      if (replace || intensity > bin.intensity) {
+        bin.range = range;
+        bin.intensity = intensity;
+      }
 
-  for (uint16_t j = 0; j < m_IgnoreArray.size(); j = j + 2) {
-    if ((angles::from_degrees(m_IgnoreArray[j]) <= angle) &&
-        (angle <= angles::from_degrees(m_IgnoreArray[j + 1]))) {
-      ret = true;
       break;
+
+    case BIN_MEAN:
+      bin.range += range;
+      bin.intensity += intensity;
+      break;
+
+    default:
+      break;
+  }
+
+  bin.valid++;
+}
+
+void CYdLidar::finishScanBins() {
+  int size = static_cast<int>(scan_bins.size());
+
+  if (m_FixedResolutionReduction == BIN_MEAN) {
+    for (int i = 0; i < size; i++) {
+      if (scan_bins[i].valid > 1) {
+        scan_bins[i].range /= scan_bins[i].valid;
+        scan_bins[i].intensity /= scan_bins[i].valid;
+      }
+    }
+  }
+
+  if (m_MaxInterpolationGap <= 0) {
+    return;
+  }
+
+  //fill runs of bins that got no sample at all from their valid neighbours
+  int last = -1;
+
+  for (int i = 0; i < size; i++) {
+    if (scan_bins[i].samples == 0) {
+      continue;
+    }
+
+    if (scan_bins[i].valid > 0) {
+      int gap = i - last - 1;
+
+      if (last >= 0 && gap > 0 && gap <= m_MaxInterpolationGap) {
+        const ScanBin &left = scan_bins[last];
+        const ScanBin &right = scan_bins[i];
+
+        for (int j = last + 1; j < i; j++) {
+          float t = static_cast<float>(j - last) / (i - last);
+          scan_bins[j].range = left.range + (right.range - left.range) * t;
+          scan_bins[j].intensity = left.intensity +
+                                   (right.intensity - left.intensity) * t;
+        }
+      }
+
+      last = i;
+    } else {
+      last = -1;
+    }
+  }
+}
+
+/*-------------------------------------------------------------
+                    updateCartesian
+-------------------------------------------------------------*/
+void CYdLidar::updateCartesian(LaserScanSoA &outscan, int fields,
+                               bool fixed_angles) {
+  if (!(fields & SCAN_FIELD_CARTESIAN)) {
+    return;
+  }
+
+  size_t size = outscan.ranges.size();
+
+  if (!fixed_angles || !unit_cached || unit_cos.size() != size ||
+      unit_min_angle != outscan.config.min_angle ||
+      unit_increment != outscan.config.angle_increment) {
+    unit_cos.resize(size);
+    unit_sin.resize(size);
+    polarUnitVectors(outscan.angles.data(), size, unit_cos.data(),
+                     unit_sin.data());
+    unit_cached = fixed_angles;
+    unit_min_angle = outscan.config.min_angle;
+    unit_increment = outscan.config.angle_increment;
+  }
+
+  outscan.x.resize(size);
+  outscan.y.resize(size);
+  polarToCartesian(outscan.ranges.data(), unit_cos.data(), unit_sin.data(),
+                   size, outscan.x.data(), outscan.y.data());
+
+  if (!(fields & SCAN_FIELD_RANGE)) {
+    outscan.ranges.clear();
+  }
+
+  if (!(fields & SCAN_FIELD_ANGLE)) {
+    outscan.angles.clear();
+  }
+}
+
+namespace {
+//scan layout helpers used by CYdLidar::processScan
+void clearScan(LaserScan &scan, int) {
+  scan.points.clear();
+}
+
+void clearScan(LaserScanSoA &scan, int) {
+  scan.ranges.clear();
+  scan.intensities.clear();
+  scan.angles.clear();
+  scan.x.clear();
+  scan.y.clear();
+}
+
+//arrays the conversion pass writes, a LaserScanSoA is converted in place and
+//the scratch arrays passed in are kept for the fields it doesn't output
+void sampleArrays(LaserScan &, int, int, float *&, float *&, float *&) {
+}
+
+void sampleArrays(LaserScanSoA &scan, int fields, int count, float *&angles,
+                  float *&ranges, float *&intensities) {
+  if (fields & SCAN_FIELD_RANGE) {
+    scan.ranges.resize(count);
+    ranges = scan.ranges.data();
+  }
+
+  if (fields & SCAN_FIELD_INTENSITY) {
+    scan.intensities.resize(count);
+    intensities = scan.intensities.data();
+  }
+
+  if (fields & SCAN_FIELD_ANGLE) {
+    scan.angles.resize(count);
+    angles = scan.angles.data();
+  }
+}
+
+//move the samples flagged in inside to the front, every sample is written
+//and the next one overwrites it if it was outside
+template <typename Vector>
+void keepSamples(Vector &samples, const int *inside, int count) {
+  size_t size = 0;
+
+  for (int i = 0; i < count; i++) {
+    samples[size] = samples[i];
+    size += inside[i];
+  }
+
+  samples.resize(size);
+}
+
+//keep the converted samples inside the angle window, all of them if all
+void keepPoints(LaserScan &scan, int, const float *angles,
+                const float *ranges, const float *intensities,
+                const int *inside, int count, bool all) {
+  scan.points.resize(count);
+  LaserPoint *points = scan.points.data();
+
+  if (all) {
+    for (int i = 0; i < count; i++) {
+      points[i].angle = angles[i];
+      points[i].range = ranges[i];
+      points[i].intensity = intensities[i];
     }
+
+    return;
+  }
+
+  size_t size = 0;
+
+  for (int i = 0; i < count; i++) {
+    points[size].angle = angles[i];
+    points[size].range = ranges[i];
+    points[size].intensity = intensities[i];
+    size += inside[i];
+  }
+
+  scan.points.resize(size);
+}
+
+void keepPoints(LaserScanSoA &scan, int fields, const float *,
+                const float *, const float *, const int *inside, int count,
+                bool all) {
+  if (all) {
+    return;
   }
 
-  return ret;
+  if (fields & SCAN_FIELD_RANGE) {
+    keepSamples(scan.ranges, inside, count);
+  }
+
+  if (fields & SCAN_FIELD_INTENSITY) {
+    keepSamples(scan.intensities, inside, count);
+  }
+
+  if (fields & SCAN_FIELD_ANGLE) {
+    keepSamples(scan.angles, inside, count);
+  }
+}
+
+void resizeScan(LaserScan &scan, int, size_t size) {
+  scan.points.resize(size);
+}
+
+void resizeScan(LaserScanSoA &scan, int fields, size_t size) {
+  if (fields & SCAN_FIELD_RANGE) {
+    scan.ranges.resize(size);
+  }
+
+  if (fields & SCAN_FIELD_INTENSITY) {
+    scan.intensities.resize(size);
+  }
+
+  if (fields & SCAN_FIELD_ANGLE) {
+    scan.angles.resize(size);
+  }
+}
+
+void setPoint(LaserScan &scan, int, size_t index, float angle, float range,
+              float intensity) {
+  LaserPoint &point = scan.points[index];
+  point.angle = angle;
+  point.range = range;
+  point.intensity = intensity;
+}
+
+void setPoint(LaserScanSoA &scan, int fields, size_t index, float angle,
+              float range, float intensity) {
+  if (fields & SCAN_FIELD_RANGE) {
+    scan.ranges[index] = range;
+  }
+
+  if (fields & SCAN_FIELD_INTENSITY) {
+    scan.intensities[index] = intensity;
+  }
+
+  if (fields & SCAN_FIELD_ANGLE) {
+    scan.angles[index] = angle;
+  }
+}
 }
 
 
@@ -150,6 +610,257 @@ bool CYdLidar::isRangeIgnore(double angle) const {
 -------------------------------------------------------------*/
 bool  CYdLidar::doProcessSimple(LaserScan &outscan,
                                 bool &hardwareError) {
+  return processScan(outscan, hardwareError);
+}
+
+bool  CYdLidar::doProcessSimple(LaserScanSoA &outscan,
+                                bool &hardwareError) {
+  return processScan(outscan, hardwareError);
+}
+
+bool CYdLidar::borrowScan(LaserScanLease &lease, bool &hardwareError) {
+  lease.release();
+  LaserScanSlot *slot = acquireLeaseSlot();
+
+  // every slot is still being read
+  if (!slot) {
+    hardwareError = false;
+    return false;
+  }
+
+  if (!processScan(slot->scan, hardwareError)) {
+    slot->refs.store(0, std::memory_order_release);
+    return false;
+  }
+
+  lease = LaserScanLease(slot);
+  return true;
+}
+
+LaserScanSlot *CYdLidar::acquireLeaseSlot() {
+  for (int i = 0; i < SCAN_LEASE_SLOTS; i++) {
+    int expected = 0;
+
+    if (lease_slots[i].refs.compare_exchange_strong(expected, 1,
+        std::memory_order_acquire)) {
+      return &lease_slots[i];
+    }
+  }
+
+  return NULL;
+}
+
+/*-------------------------------------------------------------
+						subscribe
+-------------------------------------------------------------*/
+int CYdLidar::subscribe(const ScanCallback &callback, int executor) {
+  if (isScanning || !callback) {
+    return -1;
+  }
+
+  ScanSubscriber subscriber;
+  subscriber.id = next_subscriber_id++;
+  subscriber.callback = callback;
+  subscriber.executor = executor == CALLBACK_WORKER ? CALLBACK_WORKER :
+                        CALLBACK_INLINE;
+  scan_subscribers.push_back(subscriber);
+  return subscriber.id;
+}
+
+bool CYdLidar::unsubscribe(int id) {
+  if (isScanning) {
+    return false;
+  }
+
+  for (size_t i = 0; i < scan_subscribers.size(); i++) {
+    if (scan_subscribers[i].id == id) {
+      scan_subscribers.erase(scan_subscribers.begin() + i);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+uint32_t CYdLidar::getCallbackDropCount() const {
+  return callback_drops;
+}
+
+void CYdLidar::onScanPublished(void *context) {
+  static_cast<CYdLidar *>(context)->dispatchScans();
+}
+
+void CYdLidar::dispatchScans() {
+  //still checking the lidar in turnOn, or polled by doProcessSimple
+  if (!isScanning || scan_subscribers.empty()) {
+    return;
+  }
+
+  LaserScanLease lease;
+
+  //deliver everything queued, so a deeper scan queue doesn't add latency
+  while (true) {
+    lease.release();
+    LaserScanSlot *slot = acquireLeaseSlot();
+
+    if (!slot) {
+      size_t count = YDlidarDriver::MAX_SCAN_NODES;
+
+      //every slot is held: drop the scans instead of letting them go stale
+      while (IS_OK(lidarPtr->grabScanData(global_nodes, count, global_scan_info,
+                                          0))) {
+        callback_drops++;
+        count = YDlidarDriver::MAX_SCAN_NODES;
+      }
+
+      break;
+    }
+
+    //called by the parsing thread, which is running, so the hardware check
+    //and its retry delay are skipped
+    if (!convertScan(slot->scan, 0)) {
+      //the queue is empty
+      slot->refs.store(0, std::memory_order_release);
+      break;
+    }
+
+    lease = LaserScanLease(slot);
+
+    bool queued = false;
+
+    for (size_t i = 0; i < scan_subscribers.size(); i++) {
+      if (scan_subscribers[i].executor == CALLBACK_INLINE) {
+        scan_subscribers[i].callback(lease);
+        continue;
+      }
+
+      ScopedLocker l(callback_lock);
+
+      if (callback_count < callback_tasks.size()) {
+        CallbackTask &task = callback_tasks[(callback_head + callback_count) %
+                                            callback_tasks.size()];
+        task.subscriber = i;
+        task.scan = lease;
+        callback_count++;
+        queued = true;
+      }
+    }
+
+    if (queued) {
+      callback_event.set();
+    }
+  }
+}
+
+void CYdLidar::startCallbackWorkers() {
+  size_t workers = 0;
+
+  for (size_t i = 0; i < scan_subscribers.size(); i++) {
+    if (scan_subscribers[i].executor == CALLBACK_WORKER) {
+      workers++;
+    }
+  }
+
+  if (!workers || !callback_workers.empty()) {
+    return;
+  }
+
+  //a lease slot is queued at most once per worker subscriber
+  callback_tasks.resize(workers * SCAN_LEASE_SLOTS);
+  callback_head = 0;
+  callback_count = 0;
+  callback_running = true;
+  callback_exited.set(false);
+
+  for (int i = 0; i < std::max(m_CallbackThreads, 1); i++) {
+    {
+      ScopedLocker l(callback_lock);
+      callback_active++;
+    }
+
+    Thread worker = CLASS_THREAD(CYdLidar, runCallbackWorker);
+
+    if (worker.getHandle() == 0) {
+      ScopedLocker l(callback_lock);
+      callback_active--;
+      break;
+    }
+
+    callback_workers.push_back(worker);
+  }
+}
+
+void CYdLidar::stopCallbackWorkers() {
+  if (callback_workers.empty()) {
+    return;
+  }
+
+  bool active;
+
+  {
+    ScopedLocker l(callback_lock);
+    callback_running = false;
+    active = callback_active > 0;
+  }
+
+  callback_event.set();
+
+  //let the callbacks return before join cancels the threads
+  if (active) {
+    callback_exited.wait();
+  }
+
+  for (size_t i = 0; i < callback_workers.size(); i++) {
+    callback_workers[i].join();
+  }
+
+  callback_workers.clear();
+}
+
+int CYdLidar::runCallbackWorker() {
+  while (true) {
+    CallbackTask task;
+
+    {
+      ScopedLocker l(callback_lock);
+
+      if (!callback_count) {
+        if (!callback_running) {
+          break;
+        }
+      } else {
+        CallbackTask &head = callback_tasks[callback_head];
+        task.subscriber = head.subscriber;
+        task.scan.swap(head.scan);
+        callback_head = (callback_head + 1) % callback_tasks.size();
+        callback_count--;
+      }
+    }
+
+    if (!task.scan.valid()) {
+      callback_event.wait();
+      continue;
+    }
+
+    //wake the next worker if there's more
+    callback_event.set();
+    scan_subscribers[task.subscriber].callback(task.scan);
+  }
+
+  //pass the stop on to the other workers
+  callback_event.set();
+  ScopedLocker l(callback_lock);
+
+  if (--callback_active == 0) {
+    callback_exited.set();
+  }
+
+  return 0;
+}
+
+template <typename ScanType>
+bool CYdLidar::processScan(ScanType &outscan, bool &hardwareError,
+                           uint32_t timeout) {
   hardwareError			= false;
 
   // Bound?
@@ -159,11 +870,17 @@ bool  CYdLidar::doProcessSimple(LaserScan &outscan,
     return false;
   }
 
+  return convertScan(outscan, timeout);
+}
+
+template <typename ScanType>
+bool CYdLidar::convertScan(ScanType &outscan, uint32_t timeout) {
   size_t   count = YDlidarDriver::MAX_SCAN_NODES;
   //wait Scan data:
   uint64_t tim_scan_start = getTime();
   uint64_t startTs = tim_scan_start;
-  result_t op_result =  lidarPtr->grabScanData(global_nodes, count);
+  result_t op_result =  lidarPtr->grabScanData(global_nodes, count,
+                         global_scan_info, timeout);
   uint64_t tim_scan_end = getTime();
 
   // Fill in scan data:
@@ -171,7 +888,7 @@ bool  CYdLidar::doProcessSimple(LaserScan &outscan,
     uint64_t scan_time = m_PointTime * (count - 1);
     tim_scan_end += m_OffsetTime * 1e9;
     tim_scan_end -= m_PointTime;
-    tim_scan_end -= global_nodes[0].stamp;
+    tim_scan_end -= global_scan_info.stamp;
     tim_scan_start = tim_scan_end -  scan_time ;
 
     if (tim_scan_start < startTs) {
@@ -185,13 +902,7 @@ bool  CYdLidar::doProcessSimple(LaserScan &outscan,
     }
 
     last_node_time = tim_scan_end;
-
-    if (m_MaxAngle < m_MinAngle) {
-      float temp = m_MinAngle;
-      m_MinAngle = m_MaxAngle;
-      m_MaxAngle = temp;
-    }
-
+    updateAngleTable();
     int all_node_count = count;
 
     outscan.config.min_angle = angles::from_degrees(m_MinAngle);
@@ -201,91 +912,112 @@ bool  CYdLidar::doProcessSimple(LaserScan &outscan,
     outscan.config.min_range = m_MinRange;
     outscan.config.max_range = m_MaxRange;
     outscan.stamp = tim_scan_start;
-    outscan.points.clear();
+    int fields = m_ScanFields;
+
+    //the Cartesian stage is computed from the range and angle arrays
+    if (fields & SCAN_FIELD_CARTESIAN) {
+      fields |= SCAN_FIELD_RANGE | SCAN_FIELD_ANGLE;
+    }
+
+    clearScan(outscan, fields);
 
     if (m_FixedResolution) {
       all_node_count = m_FixedSize;
     }
 
+    //grow once to a full scan instead of doubling while pushing points
+    detail::reserveScan(outscan, std::max<size_t>(count, all_node_count),
+                        fields);
+
     outscan.config.angle_increment = (outscan.config.max_angle -
                                       outscan.config.min_angle) / (all_node_count - 1);
 
-    float range = 0.0;
-    float intensity = 0.0;
-    float angle = 0.0;
-
-    for (int i = 0; i < count; i++) {
-      angle = static_cast<float>((global_nodes[i].angle_q6_checkbit >>
-                                  LIDAR_RESP_MEASUREMENT_ANGLE_SHIFT) / 64.0f) + m_AngleOffset;
-
-      if (isTOFLidar(m_LidarType)) {
-        if (isOldVersionTOFLidar(lidar_model, Major, Minjor)) {
-          range = static_cast<float>(global_nodes[i].distance_q2 / 2000.f);
-        } else {
-          range = static_cast<float>(global_nodes[i].distance_q2 / 1000.f);
-        }
-      } else {
-        if (isOctaveLidar(lidar_model)) {
-          range = static_cast<float>(global_nodes[i].distance_q2 / 2000.f);
-        } else {
-          range = static_cast<float>(global_nodes[i].distance_q2 / 4000.f);
-        }
-      }
+    bool binned = m_FixedResolution &&
+                  m_FixedResolutionReduction > BIN_NONE &&
+                  m_FixedResolutionReduction < BIN_Tail;
+    const AngleEntry *table = angle_table.data();
+    const int max_angle_q6 = static_cast<int>(angle_table.size()) - 1;
+    const float min_range = m_MinRange;
+    const float max_range = m_MaxRange;
+    float *point_angle = point_angles.data();
+    float *point_range = point_ranges.data();
+    float *point_intensity = point_intensities.data();
+    int *inside = point_inside.data();
+    int node_count = count;
+    sampleArrays(outscan, fields, node_count, point_angle, point_range,
+                 point_intensity);
+
+    //straight-line conversion of every sample, the angle window and the
+    //fixed resolution are applied by the passes below
+    for (int i = 0; i < node_count; i++) {
+      const node_sample &node = global_nodes[i];
+      const AngleEntry &entry = table[std::min<int>(node.angle_q6_checkbit >>
+                                      LIDAR_RESP_MEASUREMENT_ANGLE_SHIFT, max_angle_q6)];
+      point_angle[i] = entry.angle;
+      //ignored angles have a zero scale
+      point_range[i] = node.distance_q2 * entry.scale;
+      inside[i] = entry.inside;
+    }
 
-      intensity = static_cast<float>(global_nodes[i].sync_quality);
-      angle = angles::from_degrees(angle);
+    //the table lookup above keeps the compiler from vectorizing it, this
+    //pass has no lookup and no control flow ('&' rather than '&&') so it is
+    for (int i = 0; i < node_count; i++) {
+      //out of range samples are zeroed without a branch
+      int valid = (point_range[i] >= min_range) & (point_range[i] <= max_range);
+      point_range[i] *= valid;
+      point_intensity[i] = static_cast<float>(global_nodes[i].sync_quality) *
+                           valid;
+    }
 
-      //Rotate 180 degrees or not
-      if (m_Reversion) {
-        angle = angle + M_PI;
-      }
+    //the scan starts at the first sample inside the window
+    int first = 0;
 
-      //Is it counter clockwise
-      if (m_Inverted) {
-        angle = 2 * M_PI - angle;
-      }
+    while (first < node_count && !inside[first]) {
+      first++;
+    }
 
-      angle = angles::normalize_angle(angle);
+    if (first < node_count) {
+      outscan.stamp = tim_scan_start + first * m_PointTime;
+    }
 
-      //ignore angle
-      if (isRangeIgnore(angle)) {
-        range = 0.0;
-      }
+    if (binned) {
+      resetScanBins(all_node_count);
 
-      //valid range
-      if (!isRangeValid(range)) {
-        range = 0.0;
-        intensity = 0.0;
-      }
+      for (int i = first; i < node_count; i++) {
+        if (!inside[i]) {
+          continue;
+        }
 
-      if (angle >= outscan.config.min_angle &&
-          angle <= outscan.config.max_angle) {
-        LaserPoint point;
-        point.angle = angle;
-        point.range = range;
-        point.intensity = intensity;
+        float position = (point_angle[i] - outscan.config.min_angle) /
+                         outscan.config.angle_increment;
+        int index = static_cast<int>(std::floor(position + 0.5));
 
-        if (outscan.points.empty()) {
-          outscan.stamp = tim_scan_start + i * m_PointTime;
+        if (index >= 0 && index < all_node_count) {
+          reduceScanBin(index, std::fabs(position - index) *
+                        outscan.config.angle_increment, point_range[i],
+                        point_intensity[i]);
         }
+      }
 
-        if (m_FixedResolution) {
-          int index = std::ceil((angle - outscan.config.min_angle) /
-                                outscan.config.angle_increment);
+      finishScanBins();
+      resizeScan(outscan, fields, all_node_count);
 
-          if (index >= 0 && index < all_node_count) {
-            outscan.points.push_back(point);
-          }
-        } else {
-          outscan.points.push_back(point);
-        }
+      for (int i = 0; i < all_node_count; i++) {
+        setPoint(outscan, fields, i,
+                 outscan.config.min_angle + i * outscan.config.angle_increment,
+                 scan_bins[i].range, scan_bins[i].intensity);
       }
-    }
+    } else {
+      keepPoints(outscan, fields, point_angle, point_range, point_intensity,
+                 inside, node_count, angle_window_full);
 
-    if (m_FixedResolution) {
-      outscan.points.resize(all_node_count);
+      if (m_FixedResolution) {
+        resizeScan(outscan, fields, all_node_count);
+      }
     }
 
+    updateCartesian(outscan, m_ScanFields, binned);
+
     handleDeviceInfoPackage(count);
 
     return true;
@@ -299,39 +1031,39 @@ bool  CYdLidar::doProcessSimple(LaserScan &outscan,
 
 }
 
-void CYdLidar::parsePackageNode(const node_info &node, LaserDebug &info) {
-  switch (node.index) {
+void CYdLidar::parsePackageNode(uint8_t index, uint8_t value,
+                                LaserDebug &info) {
+  switch (index) {
     case 0://W3F4CusMajor_W4F0CusMinor;
-      info.W3F4CusMajor_W4F0CusMinor = node.debug_info[node.index];
+      info.W3F4CusMajor_W4F0CusMinor = value;
       break;
 
     case 1://W4F3Model_W3F0DebugInfTranVer
-      info.W4F3Model_W3F0DebugInfTranVer = node.debug_info[node.index];
+      info.W4F3Model_W3F0DebugInfTranVer = value;
       break;
 
     case 2://W3F4HardwareVer_W4F0FirewareMajor
-      info.W3F4HardwareVer_W4F0FirewareMajor = node.debug_info[node.index];
+      info.W3F4HardwareVer_W4F0FirewareMajor = value;
       break;
 
     case 4://W3F4BoradHardVer_W4F0Moth
-      info.W3F4BoradHardVer_W4F0Moth = node.debug_info[node.index];
+      info.W3F4BoradHardVer_W4F0Moth = value;
       break;
 
     case 5://W2F5Output2K4K5K_W5F0Date
-      info.W2F5Output2K4K5K_W5F0Date = node.debug_info[node.index];
+      info.W2F5Output2K4K5K_W5F0Date = value;
       break;
 
     case 6://W1F6GNoise_W1F5SNoise_W1F4MotorCtl_W4F0SnYear
-      info.W1F6GNoise_W1F5SNoise_W1F4MotorCtl_W4F0SnYear =
-        node.debug_info[node.index];
+      info.W1F6GNoise_W1F5SNoise_W1F4MotorCtl_W4F0SnYear = value;
       break;
 
     case 7://W7F0SnNumH
-      info.W7F0SnNumH = node.debug_info[node.index];
+      info.W7F0SnNumH = value;
       break;
 
     case 8://W7F0SnNumL
-      info.W7F0SnNumL = node.debug_info[node.index];
+      info.W7F0SnNumL = value;
 
       break;
 
@@ -339,8 +1071,8 @@ void CYdLidar::parsePackageNode(const node_info &node, LaserDebug &info) {
       break;
   }
 
-  if (node.index > info.MaxDebugIndex && node.index < 100) {
-    info.MaxDebugIndex = static_cast<int>(node.index);
+  if (index > info.MaxDebugIndex && index < 100) {
+    info.MaxDebugIndex = static_cast<int>(index);
   }
 }
 
@@ -352,8 +1084,10 @@ void CYdLidar::handleDeviceInfoPackage(int count) {
   LaserDebug debug;
   debug.MaxDebugIndex = 0;
 
-  for (int i = 0; i < count; i++) {
-    parsePackageNode(global_nodes[i], debug);
+  for (int i = 0; i < _countof(global_scan_info.debug_info); i++) {
+    if (global_scan_info.debug_mask & (1 << i)) {
+      parsePackageNode(i, global_scan_info.debug_info[i], debug);
+    }
   }
 
   device_info info;
@@ -424,6 +1158,10 @@ bool  CYdLidar::turnOn() {
   }
 
   m_PointTime = lidarPtr->getPointTime();
+  //the range scale depends on the model and firmware, rebuild every time
+  angle_table.clear();
+  updateAngleTable();
+  startCallbackWorkers();
   isScanning = true;
   lidarPtr->setAutoReconnect(m_AutoReconnect);
   printf("[YDLIDAR INFO] Current Sampling Rate : %dK\n", m_SampleRate);
@@ -440,6 +1178,8 @@ bool  CYdLidar::turnOff() {
     lidarPtr->stop();
   }
 
+  stopCallbackWorkers();
+
   if (isScanning) {
     printf("[YDLIDAR INFO] Now YDLIDAR Scanning has stopped ......\n");
   }
@@ -479,7 +1219,7 @@ bool CYdLidar::checkLidarAbnormal() {
                                  !lidarPtr->getSingleChannel()) && IS_OK(op_result)) {
       start_time = getms();
       count = YDlidarDriver::MAX_SCAN_NODES;
-      op_result =  lidarPtr->grabScanData(global_nodes, count);
+      op_result =  lidarPtr->grabScanData(global_nodes, count, global_scan_info);
       end_time = getms();
       scan_time = 1.0 * static_cast<int32_t>(end_time - start_time) / 1e3;
       buffer_count++;
@@ -502,7 +1242,7 @@ bool CYdLidar::checkLidarAbnormal() {
       while (collection < 5) {
         count = YDlidarDriver::MAX_SCAN_NODES;
         start_time = getms();
-        op_result =  lidarPtr->grabScanData(global_nodes, count);
+        op_result =  lidarPtr->grabScanData(global_nodes, count, global_scan_info);
         end_time = getms();
 
 
@@ -598,14 +1338,13 @@ bool CYdLidar::getDeviceInfo() {
   }
 
   frequencyOffset     = 0.4;
-  std::string model = "G2";
   lidar_model = devinfo.model;
-  model = lidarModelToString(devinfo.model);
-  bool intensity = hasIntensity(devinfo.model);
-  defalutSampleRate = lidarModelDefaultSampleRate(devinfo.model);
+  lidar_model_info = &lidarModelInfo(lidar_model);
+  bool intensity = lidar_model_info->hasIntensity();
+  defalutSampleRate = lidar_model_info->default_sample_rate;
 
   if (!isTOFLidar(m_LidarType)) {
-    if (isTOFLidarByModel(devinfo.model)) {
+    if (lidar_model_info->isTOF()) {
       m_LidarType = TYPE_TOF;
       lidarPtr->setLidarType(m_LidarType);
     }
@@ -629,17 +1368,17 @@ bool CYdLidar::getDeviceInfo() {
 
   m_UserSampleRate = m_SampleRate;
 
-  if (hasSampleRate(devinfo.model)) {
+  if (lidar_model_info->hasSampleRate()) {
     checkSampleRate();
   } else {
     m_SampleRate = defalutSampleRate;
   }
 
-  if (hasScanFrequencyCtrl(devinfo.model)) {
+  if (lidar_model_info->hasScanFrequencyCtrl()) {
     checkScanFrequency();
   }
 
-  if (hasZeroAngle(devinfo.model)) {
+  if (lidar_model_info->hasZeroAngle()) {
     checkCalibrationAngle(serial_number);
   }
 
@@ -670,8 +1409,11 @@ void CYdLidar::printfVersionInfo(const device_info &info) {
 
   m_ParseSuccess = true;
   lidar_model = info.model;
+  lidar_model_info = &lidarModelInfo(lidar_model);
   Major = (uint8_t)(info.firmware_version >> 8);
   Minjor = (uint8_t)(info.firmware_version & 0xff);
+  //rebuilt with the range scale of this model and firmware
+  angle_table.clear();
   printf("[YDLIDAR] Connection established in [%s][%d]:\n"
          "Firmware version: %u.%u\n"
          "Hardware version: %u\n"
@@ -682,7 +1424,7 @@ void CYdLidar::printfVersionInfo(const device_info &info) {
          Major,
          Minjor,
          (unsigned int)info.hardware_version,
-         lidarModelToString(lidar_model).c_str());
+         lidar_model_info->name);
 
   for (int i = 0; i < 16; i++) {
     printf("%01X", info.serialnum[i] & 0xff);
@@ -724,12 +1466,12 @@ bool CYdLidar::CalculateSampleRate(int count, double scan_time) {
     return false;
   }
 
-  if (global_nodes[0].scan_frequence != 0) {
-    double scanfrequency  = global_nodes[0].scan_frequence / 10.0;
+  if (global_scan_info.scan_frequence != 0) {
+    double scanfrequency  = global_scan_info.scan_frequence / 10.0;
 
     if (isTOFLidar(m_LidarType)) {
-      if (!isOldVersionTOFLidar(lidar_model, Major, Minjor)) {
-        scanfrequency  = global_nodes[0].scan_frequence / 10.0 + 3.0;
+      if (!isOldVersionTOFLidar(*lidar_model_info, Major, Minjor)) {
+        scanfrequency  = global_scan_info.scan_frequence / 10.0 + 3.0;
       }
     }
 
@@ -787,7 +1529,7 @@ bool CYdLidar::checkScanFrequency() {
   float hz = 0;
   result_t ans = RESULT_FAIL;
 
-  if (isSupportScanFrequency(lidar_model, m_ScanFrequency)) {
+  if (isSupportScanFrequency(*lidar_model_info, m_ScanFrequency)) {
     m_ScanFrequency += frequencyOffset;
     ans = lidarPtr->getScanFrequency(_scan_frequency) ;
 
@@ -915,6 +1657,8 @@ bool  CYdLidar::checkCOMMs() {
   }
 
   // make connection...
+  lidarPtr->setLowLatency(m_LowLatency);
+  lidarPtr->setLidarManager(lidarManager);
   result_t op_result = lidarPtr->connect(m_SerialPort.c_str(), m_SerialBaudrate);
 
   if (!IS_OK(op_result)) {
@@ -927,6 +1671,10 @@ bool  CYdLidar::checkCOMMs() {
   printf("LiDAR successfully connected\n");
   lidarPtr->setSingleChannel(m_SingleChannel);
   lidarPtr->setLidarType(m_LidarType);
+  lidarPtr->setScanQueueSize(m_ScanQueueSize);
+  lidarPtr->setScanQueuePolicy(m_ScanQueuePolicy);
+  lidarPtr->setWakeupRate(m_WakeupRate);
+  lidarPtr->setScanPublishedCallback(&CYdLidar::onScanPublished, this);
 
   return true;
 }
@@ -2,6 +2,8 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
+#include <limits.h>
 #include <sstream>
 #include <unistd.h>
 #include <fcntl.h>
@@ -26,6 +28,13 @@
 #endif
 
 #include <sys/select.h>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#define HAVE_EPOLL 1
+#endif
+#if defined(__linux__) && defined(YDLIDAR_WITH_IO_URING)
+#define HAVE_IO_URING 1
+#endif
 #include <sys/time.h>
 #include <sys/stat.h>
 #include <time.h>
@@ -640,9 +649,15 @@ Serial::SerialImpl::SerialImpl(const string &port, unsigned long baudrate,
                                bytesize_t bytesize,
                                parity_t parity, stopbits_t stopbits,
                                flowcontrol_t flowcontrol)
-  : port_(port), fd_(-1), is_open_(false), xonxoff_(false), rtscts_(false),
+  : port_(port), fd_(-1), epoll_fd_(-1), is_open_(false), xonxoff_(false), rtscts_(false),
     baudrate_(baudrate), parity_(parity),
-    bytesize_(bytesize), stopbits_(stopbits), flowcontrol_(flowcontrol) {
+    bytesize_(bytesize), stopbits_(stopbits), flowcontrol_(flowcontrol),
+    low_latency_(false), low_latency_applied_(low_latency_none),
+    saved_vmin_(0), saved_vtime_(0), saved_async_low_latency_(false),
+    saved_latency_timer_(-1) {
+#ifdef HAVE_IO_URING
+  uring_ = NULL;
+#endif
   pthread_mutex_init(&this->read_mutex, NULL);
   pthread_mutex_init(&this->write_mutex, NULL);
 
@@ -723,6 +738,38 @@ bool Serial::SerialImpl::open() {
     return false;
   }
 
+#ifdef HAVE_EPOLL
+  // Wake on every arrival of new bytes instead of polling with sleeps.
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+
+  if (epoll_fd_ != -1) {
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = fd_;
+
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd_, &event) == -1) {
+      ::close(epoll_fd_);
+      epoll_fd_ = -1;
+    }
+  }
+
+#endif
+#ifdef HAVE_IO_URING
+  // Keep a read outstanding in io_uring, plain reads if unsupported.
+  uring_ = new UringReader();
+
+  if (!uring_->open(fd_)) {
+    delete uring_;
+    uring_ = NULL;
+  }
+
+#endif
+
+  if (low_latency_) {
+    low_latency_applied_ = applyLowLatency();
+  }
+
   // Update byte_time_ based on the new settings.
   uint32_t bit_time_ns = 1e9 / baudrate_;
   byte_time_ns_ = bit_time_ns * (1 + bytesize_ + parity_ + stopbits_);
@@ -740,6 +787,23 @@ bool Serial::SerialImpl::open() {
 
 void Serial::SerialImpl::close() {
   if (is_open_ == true) {
+    if (low_latency_applied_ != low_latency_none) {
+      restoreLowLatency();
+    }
+
+#ifdef HAVE_IO_URING
+
+    if (uring_) {
+      delete uring_;
+      uring_ = NULL;
+    }
+
+#endif
+
+    if (epoll_fd_ != -1) {
+      ::close(epoll_fd_);
+    }
+
     if (fd_ != -1) {
       ::close(fd_);
     }
@@ -748,11 +812,145 @@ void Serial::SerialImpl::close() {
     UNLOCK(port_.c_str(), pid);
 #endif
     fd_ = -1;
+    epoll_fd_ = -1;
     pid = -1;
     is_open_ = false;
   }
 }
 
+int Serial::SerialImpl::setLowLatency(bool enable) {
+  low_latency_ = enable;
+
+  if (fd_ == -1) {
+    return low_latency_applied_;
+  }
+
+  if (enable && low_latency_applied_ == low_latency_none) {
+    low_latency_applied_ = applyLowLatency();
+  } else if (!enable && low_latency_applied_ != low_latency_none) {
+    restoreLowLatency();
+  }
+
+  return low_latency_applied_;
+}
+
+int Serial::SerialImpl::getLowLatency() const {
+  return low_latency_applied_;
+}
+
+int Serial::SerialImpl::getReadFd() const {
+#ifdef HAVE_IO_URING
+
+  // bytes are moved out of the tty by the ring, fd_ never polls readable
+  if (uring_) {
+    return -1;
+  }
+
+#endif
+  return fd_;
+}
+
+int Serial::SerialImpl::applyLowLatency() {
+  int applied = low_latency_none;
+  termios tio;
+
+  // Wake on the first byte, no inter-character timer.
+  if (::tcgetattr(fd_, &tio) != -1) {
+    saved_vmin_ = tio.c_cc[VMIN];
+    saved_vtime_ = tio.c_cc[VTIME];
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+
+    if (::tcsetattr(fd_, TCSANOW, &tio) != -1) {
+      applied |= low_latency_termios;
+    }
+  }
+
+#if defined(__linux__) && !defined(__ANDROID__)
+  struct serial_struct serial;
+  ::memset(&serial, 0, sizeof(serial));
+
+  if (::ioctl(fd_, TIOCGSERIAL, &serial) != -1) {
+    saved_async_low_latency_ = (serial.flags & ASYNC_LOW_LATENCY) != 0;
+    serial.flags |= ASYNC_LOW_LATENCY;
+
+    if (::ioctl(fd_, TIOCSSERIAL, &serial) != -1) {
+      applied |= low_latency_async;
+    }
+  }
+
+  // USB serial adapters batch input for latency_timer ms, FTDI exposes it
+  // in sysfs. Needs write access to the attribute.
+  char real_path[PATH_MAX];
+  latency_timer_path_.clear();
+  saved_latency_timer_ = -1;
+
+  if (::realpath(port_.c_str(), real_path)) {
+    const char *name = strrchr(real_path, '/');
+    name = name ? name + 1 : real_path;
+    latency_timer_path_ = string("/sys/class/tty/") + name +
+                          "/device/latency_timer";
+    FILE *fp = fopen(latency_timer_path_.c_str(), "r");
+
+    if (fp) {
+      if (fscanf(fp, "%d", &saved_latency_timer_) != 1) {
+        saved_latency_timer_ = -1;
+      }
+
+      fclose(fp);
+    }
+
+    if (saved_latency_timer_ >= 0) {
+      fp = fopen(latency_timer_path_.c_str(), "w");
+
+      if (fp) {
+        if (fprintf(fp, "1") > 0 && fclose(fp) == 0) {
+          applied |= low_latency_usb_timer;
+        }
+      }
+    }
+  }
+
+#endif
+  return applied;
+}
+
+void Serial::SerialImpl::restoreLowLatency() {
+  if (low_latency_applied_ & low_latency_termios) {
+    termios tio;
+
+    if (::tcgetattr(fd_, &tio) != -1) {
+      tio.c_cc[VMIN] = saved_vmin_;
+      tio.c_cc[VTIME] = saved_vtime_;
+      ::tcsetattr(fd_, TCSANOW, &tio);
+    }
+  }
+
+#if defined(__linux__) && !defined(__ANDROID__)
+
+  if ((low_latency_applied_ & low_latency_async) && !saved_async_low_latency_) {
+    struct serial_struct serial;
+    ::memset(&serial, 0, sizeof(serial));
+
+    if (::ioctl(fd_, TIOCGSERIAL, &serial) != -1) {
+      serial.flags &= ~ASYNC_LOW_LATENCY;
+      ::ioctl(fd_, TIOCSSERIAL, &serial);
+    }
+  }
+
+  if (low_latency_applied_ & low_latency_usb_timer) {
+    FILE *fp = fopen(latency_timer_path_.c_str(), "w");
+
+    if (fp) {
+      fprintf(fp, "%d", saved_latency_timer_);
+      fclose(fp);
+    }
+  }
+
+#endif
+  low_latency_applied_ = low_latency_none;
+}
+
 bool Serial::SerialImpl::isOpen() const {
   return is_open_;
 }
@@ -763,15 +961,41 @@ size_t Serial::SerialImpl::available() {
   }
 
   int count = 0;
+  size_t buffered = 0;
+#ifdef HAVE_IO_URING
+
+  if (uring_) {
+    buffered = uring_->buffered();
+  }
+
+#endif
 
   if (-1 == ioctl(fd_, TIOCINQ, &count)) {
-    return 0;
+    return buffered;
   } else {
-    return static_cast<size_t>(count);
+    return buffered + static_cast<size_t>(count);
   }
 }
 
 bool Serial::SerialImpl::waitReadable(uint32_t timeout) {
+#ifdef HAVE_IO_URING
+
+  if (uring_) {
+    return uring_->buffered() > 0 || uring_->wait(timeout) > 0;
+  }
+
+#endif
+#ifdef HAVE_EPOLL
+
+  if (epoll_fd_ != -1) {
+    if (available() > 0) {
+      return true;
+    }
+
+    return waitEvent(timeout) > 0;
+  }
+
+#endif
   // Setup a select call to block for serial data or a timeout
   fd_set readfds;
   FD_ZERO(&readfds);
@@ -803,6 +1027,38 @@ bool Serial::SerialImpl::waitReadable(uint32_t timeout) {
   return true;
 }
 
+int Serial::SerialImpl::waitEvent(uint32_t timeout) {
+#ifdef HAVE_EPOLL
+
+  if (epoll_fd_ != -1) {
+    epoll_event event;
+    int n = epoll_wait(epoll_fd_, &event, 1, static_cast<int>(timeout));
+
+    if (n < 0) {
+      return errno == EINTR ? 0 : -1;
+    }
+
+    if (n > 0 && (event.events & (EPOLLERR | EPOLLHUP))) {
+      return -1;
+    }
+
+    return n > 0 ? 1 : 0;
+  }
+
+#endif
+  fd_set readfds;
+  FD_ZERO(&readfds);
+  FD_SET(fd_, &readfds);
+  timespec timeout_ts(timespec_from_ms(timeout));
+  int r = pselect(fd_ + 1, &readfds, NULL, NULL, &timeout_ts, NULL);
+
+  if (r < 0) {
+    return errno == EINTR ? 0 : -1;
+  }
+
+  return r > 0 ? 1 : 0;
+}
+
 
 int Serial::SerialImpl::waitfordata(size_t data_count, uint32_t timeout,
                                     size_t *returned_size) {
@@ -814,6 +1070,71 @@ int Serial::SerialImpl::waitfordata(size_t data_count, uint32_t timeout,
 
   *returned_size = 0;
 
+#ifdef HAVE_IO_URING
+
+  if (uring_) {
+    // Only bytes already completed into the ring count, read() never blocks
+    // on them.
+    MillisecondTimer total_timeout(timeout);
+
+    while (is_open_) {
+      *returned_size = uring_->buffered();
+
+      // a full ring can't grow until the caller reads, report it readable
+      if (*returned_size >= data_count || uring_->full()) {
+        return 0;
+      }
+
+      int64_t timeout_remaining_ms = total_timeout.remaining();
+
+      if (timeout_remaining_ms <= 0) {
+        return -1;
+      }
+
+      if (uring_->wait(static_cast<uint32_t>(timeout_remaining_ms)) < 0) {
+        return -2;
+      }
+    }
+
+    return -2;
+  }
+
+#endif
+#ifdef HAVE_EPOLL
+
+  if (epoll_fd_ != -1) {
+    // Sleep until the kernel reports new bytes, no byte time estimates.
+    MillisecondTimer total_timeout(timeout);
+
+    while (is_open_) {
+      int count = 0;
+
+      if (ioctl(fd_, FIONREAD, &count) == -1) {
+        return -2;
+      }
+
+      *returned_size = static_cast<size_t>(count);
+
+      if (*returned_size >= data_count) {
+        return 0;
+      }
+
+      int64_t timeout_remaining_ms = total_timeout.remaining();
+
+      if (timeout_remaining_ms <= 0) {
+        return -1;
+      }
+
+      if (waitEvent(static_cast<uint32_t>(timeout_remaining_ms)) < 0) {
+        return -2;
+      }
+    }
+
+    return -2;
+  }
+
+#endif
+
   int max_fd;
   fd_set input_set;
   struct timeval timeout_val;
@@ -903,6 +1224,32 @@ size_t Serial::SerialImpl::read(uint8_t *buf, size_t size) {
   long total_timeout_ms = timeout_.read_timeout_constant;
   total_timeout_ms += timeout_.read_timeout_multiplier * static_cast<long>(size);
   MillisecondTimer total_timeout(total_timeout_ms);
+#ifdef HAVE_IO_URING
+
+  if (uring_) {
+    bytes_read = uring_->read(buf, size);
+
+    while (bytes_read < size) {
+      int64_t timeout_remaining_ms = total_timeout.remaining();
+
+      if (timeout_remaining_ms <= 0) {
+        break;
+      }
+
+      uint32_t timeout = std::min(static_cast<uint32_t>(timeout_remaining_ms),
+                                  timeout_.inter_byte_timeout);
+
+      if (uring_->wait(timeout) < 0) {
+        break;
+      }
+
+      bytes_read += uring_->read(buf + bytes_read, size - bytes_read);
+    }
+
+    return bytes_read;
+  }
+
+#endif
 
   // Pre-fill buffer with available bytes
   {
@@ -1353,6 +1700,13 @@ void Serial::SerialImpl::flushInput() {
   }
 
   tcflush(fd_, TCIFLUSH);
+#ifdef HAVE_IO_URING
+
+  if (uring_) {
+    uring_->discard();
+  }
+
+#endif
 }
 
 void Serial::SerialImpl::flushOutput() {
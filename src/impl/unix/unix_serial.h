@@ -7,6 +7,7 @@
 #include <assert.h>
 #include <termios.h>
 #include "serial.h"
+#include "unix_uring.h"
 
 namespace serial {
 
@@ -45,6 +46,14 @@ class Serial::SerialImpl {
 
   bool waitReadable(uint32_t timeout);
 
+  /**
+   * Block until new data arrives on the port or timeout (ms) expires.
+   * Returns 1 on new data, 0 on timeout, -1 on error.
+   * On Linux this is an edge triggered epoll wait, so bytes that were
+   * already queued do not wake it again; check available() first.
+   */
+  int waitEvent(uint32_t timeout);
+
   void waitByteTimes(size_t count);
 
   int waitfordata(size_t data_count, uint32_t timeout, size_t *returned_size);
@@ -80,6 +89,12 @@ class Serial::SerialImpl {
 
   uint32_t getByteTime();
 
+  int setLowLatency(bool enable);
+
+  int getLowLatency() const;
+
+  int getReadFd() const;
+
   void setPort(const string &port);
 
   string getPort() const;
@@ -128,6 +143,10 @@ class Serial::SerialImpl {
  private:
   string port_;               // Path to the file descriptor
   int fd_;                    // The current file descriptor
+  int epoll_fd_;              // epoll instance watching fd_, -1 if unused
+#if defined(__linux__) && defined(YDLIDAR_WITH_IO_URING)
+  UringReader *uring_;        // io_uring read path, NULL if unavailable
+#endif
   pid_t pid;
 
   bool is_open_;
@@ -143,6 +162,17 @@ class Serial::SerialImpl {
   stopbits_t stopbits_;       // Stop Bits
   flowcontrol_t flowcontrol_; // Flow Control
 
+  bool low_latency_;          // Low latency mode requested
+  int low_latency_applied_;   // low_latency_t settings in effect
+  cc_t saved_vmin_;           // VMIN before low latency mode
+  cc_t saved_vtime_;          // VTIME before low latency mode
+  bool saved_async_low_latency_; // ASYNC_LOW_LATENCY before low latency mode
+  int saved_latency_timer_;   // latency_timer before low latency mode [ms]
+  string latency_timer_path_; // sysfs latency_timer of the USB serial adapter
+
+  int applyLowLatency();
+  void restoreLowLatency();
+
   // Mutex used to lock the read functions
   pthread_mutex_t read_mutex;
   // Mutex used to lock the write functions
@@ -0,0 +1,359 @@
+#if defined(__linux__) && defined(YDLIDAR_WITH_IO_URING)
+
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <endian.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#include "unix_uring.h"
+
+namespace serial {
+
+namespace {
+enum {
+  POLL_TAG = 1,
+  READ_TAG = 2,
+};
+
+inline unsigned load_acquire(const unsigned *p) {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+inline void store_release(unsigned *p, unsigned v) {
+  __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+}
+
+UringReader::UringReader()
+  : ring_fd_(-1), fd_(-1), error_(false),
+    sq_ring_(MAP_FAILED), sq_ring_size_(0), sq_head_(NULL), sq_tail_(NULL),
+    sq_mask_(NULL), sq_array_(NULL), sqes_(NULL), sqes_size_(0),
+    cq_ring_(MAP_FAILED), cq_ring_size_(0), cq_head_(NULL), cq_tail_(NULL),
+    cq_mask_(NULL), cqes_(NULL), skip_poll_cqe_(false), buffers_(NULL),
+    offset_(0), head_(0), count_(0), inflight_(false) {
+  memset(length_, 0, sizeof(length_));
+}
+
+UringReader::~UringReader() {
+  close();
+}
+
+bool UringReader::open(int fd) {
+  close();
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = syscall(__NR_io_uring_setup, QUEUE_DEPTH, &params);
+
+  if (ring_fd_ < 0) {
+    ring_fd_ = -1;
+    return false;
+  }
+
+  // timed waits need IORING_ENTER_EXT_ARG (linux 5.11)
+  if (!(params.features & IORING_FEAT_EXT_ARG)) {
+    close();
+    return false;
+  }
+
+  // a successful poll needs no completion, the read reports for the chain
+#ifdef IORING_FEAT_CQE_SKIP
+  skip_poll_cqe_ = (params.features & IORING_FEAT_CQE_SKIP) != 0;
+#endif
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(
+                    io_uring_cqe);
+
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    if (cq_ring_size_ > sq_ring_size_) {
+      sq_ring_size_ = cq_ring_size_;
+    }
+
+    cq_ring_size_ = 0;
+  }
+
+  sq_ring_ = mmap(NULL, sq_ring_size_, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+
+  if (sq_ring_ == MAP_FAILED) {
+    close();
+    return false;
+  }
+
+  if (cq_ring_size_) {
+    cq_ring_ = mmap(NULL, cq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+
+    if (cq_ring_ == MAP_FAILED) {
+      close();
+      return false;
+    }
+  }
+
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(NULL, sqes_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+
+  if (sqes == MAP_FAILED) {
+    close();
+    return false;
+  }
+
+  sqes_ = static_cast<io_uring_sqe *>(sqes);
+  uint8_t *sq = static_cast<uint8_t *>(sq_ring_);
+  uint8_t *cq = static_cast<uint8_t *>(cq_ring_size_ ? cq_ring_ : sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+  void *buffers = mmap(NULL, BUFFER_COUNT * BUFFER_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if (buffers == MAP_FAILED) {
+    close();
+    return false;
+  }
+
+  buffers_ = static_cast<uint8_t *>(buffers);
+  iovec iov;
+  iov.iov_base = buffers_;
+  iov.iov_len = BUFFER_COUNT * BUFFER_SIZE;
+
+  if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS,
+              &iov, 1) < 0) {
+    close();
+    return false;
+  }
+
+  fd_ = fd;
+  error_ = false;
+  offset_ = 0;
+  head_ = 0;
+  count_ = 0;
+  inflight_ = false;
+
+  // queued only, the first wait() submits it
+  submitRead();
+  return true;
+}
+
+void UringReader::close() {
+  // closing the ring cancels the outstanding chain
+  if (ring_fd_ != -1) {
+    ::close(ring_fd_);
+    ring_fd_ = -1;
+  }
+
+  if (sqes_) {
+    munmap(sqes_, sqes_size_);
+    sqes_ = NULL;
+  }
+
+  if (cq_ring_ != MAP_FAILED) {
+    munmap(cq_ring_, cq_ring_size_);
+    cq_ring_ = MAP_FAILED;
+  }
+
+  if (sq_ring_ != MAP_FAILED) {
+    munmap(sq_ring_, sq_ring_size_);
+    sq_ring_ = MAP_FAILED;
+  }
+
+  if (buffers_) {
+    munmap(buffers_, BUFFER_COUNT * BUFFER_SIZE);
+    buffers_ = NULL;
+  }
+
+  fd_ = -1;
+  count_ = 0;
+  offset_ = 0;
+  inflight_ = false;
+}
+
+size_t UringReader::buffered() const {
+  size_t size = 0;
+
+  for (int i = 0; i < count_; i++) {
+    size += length_[(head_ + i) % BUFFER_COUNT];
+  }
+
+  return size - offset_;
+}
+
+int UringReader::enter(unsigned to_submit, unsigned min_complete,
+                       uint32_t timeout) {
+  int ret;
+
+  if (min_complete) {
+    __kernel_timespec ts;
+    ts.tv_sec = timeout / 1000;
+    ts.tv_nsec = (timeout % 1000) * 1000000LL;
+    io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+    ret = syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete,
+                  IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg,
+                  sizeof(arg));
+  } else {
+    ret = syscall(__NR_io_uring_enter, ring_fd_, to_submit, 0, 0, NULL, 0);
+  }
+
+  if (ret < 0 && (errno == ETIME || errno == EINTR)) {
+    return 0;
+  }
+
+  return ret;
+}
+
+void UringReader::submitRead() {
+  if (inflight_ || error_ || count_ == BUFFER_COUNT) {
+    return;
+  }
+
+  // POLL_ADD linked to READ_FIXED: the fd is non-blocking, so the read is
+  // only issued once the tty reports data. The pair is only queued here and
+  // submitted by the io_uring_enter in wait(), one syscall per read.
+  unsigned mask = *sq_mask_;
+  unsigned tail = *sq_tail_;
+  io_uring_sqe *poll = &sqes_[tail & mask];
+  memset(poll, 0, sizeof(*poll));
+  poll->opcode = IORING_OP_POLL_ADD;
+  poll->fd = fd_;
+#if __BYTE_ORDER == __BIG_ENDIAN
+  poll->poll32_events = (POLLIN << 16) | (POLLIN >> 16);
+#else
+  poll->poll32_events = POLLIN;
+#endif
+  poll->flags = IOSQE_IO_LINK;
+#ifdef IOSQE_CQE_SKIP_SUCCESS
+
+  if (skip_poll_cqe_) {
+    poll->flags |= IOSQE_CQE_SKIP_SUCCESS;
+  }
+
+#endif
+  poll->user_data = POLL_TAG;
+  sq_array_[tail & mask] = tail & mask;
+  tail++;
+
+  int index = (head_ + count_) % BUFFER_COUNT;
+  io_uring_sqe *read = &sqes_[tail & mask];
+  memset(read, 0, sizeof(*read));
+  read->opcode = IORING_OP_READ_FIXED;
+  read->fd = fd_;
+  read->addr = reinterpret_cast<uint64_t>(buffers_ + index * BUFFER_SIZE);
+  read->len = BUFFER_SIZE;
+  read->buf_index = 0;
+  read->user_data = READ_TAG;
+  sq_array_[tail & mask] = tail & mask;
+  tail++;
+
+  store_release(sq_tail_, tail);
+  inflight_ = true;
+}
+
+int UringReader::reap() {
+  unsigned head = *cq_head_;
+  unsigned tail = load_acquire(cq_tail_);
+  unsigned mask = *cq_mask_;
+  int got = 0;
+
+  for (; head != tail; head++) {
+    const io_uring_cqe &cqe = cqes_[head & mask];
+
+    if (cqe.user_data == READ_TAG) {
+      inflight_ = false;
+
+      if (cqe.res > 0) {
+        length_[(head_ + count_) % BUFFER_COUNT] = cqe.res;
+        count_++;
+        got = 1;
+      } else if (cqe.res != -EAGAIN && cqe.res != -EINTR) {
+        // 0 is a hang up, -ECANCELED follows a failed poll
+        error_ = true;
+      }
+    } else if (cqe.res < 0) {
+      error_ = true;
+    }
+  }
+
+  store_release(cq_head_, head);
+  submitRead();
+  return got;
+}
+
+int UringReader::wait(uint32_t timeout) {
+  if (ring_fd_ == -1 || error_) {
+    return -1;
+  }
+
+  if (reap()) {
+    return 1;
+  }
+
+  // every buffer is full, nothing completes until read() frees one
+  if (!inflight_) {
+    return error_ ? -1 : 1;
+  }
+
+  // submit the queued chain, if any, and wait in the same syscall
+  unsigned pending = *sq_tail_ - load_acquire(sq_head_);
+
+  if (enter(pending, 1, timeout) < 0) {
+    error_ = true;
+  }
+
+  if (reap()) {
+    return 1;
+  }
+
+  return error_ ? -1 : 0;
+}
+
+size_t UringReader::read(uint8_t *buf, size_t size) {
+  size_t bytes_read = 0;
+
+  while (bytes_read < size && count_ > 0) {
+    size_t length = length_[head_] - offset_;
+
+    if (length > size - bytes_read) {
+      length = size - bytes_read;
+    }
+
+    memcpy(buf + bytes_read, buffers_ + head_ * BUFFER_SIZE + offset_, length);
+    bytes_read += length;
+    offset_ += length;
+
+    if (offset_ == length_[head_]) {
+      head_ = (head_ + 1) % BUFFER_COUNT;
+      count_--;
+      offset_ = 0;
+    }
+  }
+
+  // a buffer freed up after the ring was full
+  submitRead();
+  return bytes_read;
+}
+
+void UringReader::discard() {
+  head_ = (head_ + count_) % BUFFER_COUNT;
+  count_ = 0;
+  offset_ = 0;
+  submitRead();
+}
+
+}
+
+#endif // defined(__linux__) && defined(YDLIDAR_WITH_IO_URING)
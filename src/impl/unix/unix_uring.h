@@ -0,0 +1,106 @@
+#if defined(__linux__) && defined(YDLIDAR_WITH_IO_URING)
+
+#ifndef SERIAL_IMPL_UNIX_URING_H
+#define SERIAL_IMPL_UNIX_URING_H
+
+#include <stddef.h>
+#include "v8stdint.h"
+
+namespace serial {
+
+/**
+ * Asynchronous reader of a tty fd on top of io_uring.
+ *
+ * A linked POLL_ADD + READ_FIXED pair is always kept outstanding against the
+ * fd, completing into a ring of registered buffers, so new bytes are moved
+ * out of the tty queue without a read(2) per call. Filled buffers are handed
+ * out in arrival order by read().
+ */
+class UringReader {
+ public:
+  UringReader();
+  ~UringReader();
+
+  /**
+   * Set up the ring for fd.
+   * Returns false if io_uring is unavailable, the caller should then keep
+   * using plain read(2).
+   */
+  bool open(int fd);
+
+  void close();
+
+  /** Bytes that have completed and not been read yet. */
+  size_t buffered() const;
+
+  /**
+   * Submit the queued read and collect completions, blocking up to timeout
+   * (ms) if there are none.
+   * Returns 1 if new bytes were buffered or every buffer is full, 0 on
+   * timeout, -1 on error.
+   */
+  int wait(uint32_t timeout);
+
+  /** Copy up to size buffered bytes into buf, never blocks. */
+  size_t read(uint8_t *buf, size_t size);
+
+  /** Drop all buffered bytes. */
+  void discard();
+
+  /** Returns true if no more bytes can be buffered before a read(). */
+  bool full() const {
+    return count_ == BUFFER_COUNT;
+  }
+
+ private:
+  enum {
+    BUFFER_COUNT = 4,     // registered buffers
+    BUFFER_SIZE = 4096,   // bytes per buffer
+    QUEUE_DEPTH = 8,      // submission queue entries
+  };
+
+  void submitRead();
+  int reap();
+  int enter(unsigned to_submit, unsigned min_complete, uint32_t timeout);
+
+  int ring_fd_;
+  int fd_;
+  bool error_;
+
+  // submission queue
+  void *sq_ring_;
+  size_t sq_ring_size_;
+  unsigned *sq_head_;
+  unsigned *sq_tail_;
+  unsigned *sq_mask_;
+  unsigned *sq_array_;
+  struct io_uring_sqe *sqes_;
+  size_t sqes_size_;
+
+  // completion queue
+  void *cq_ring_;
+  size_t cq_ring_size_;
+  unsigned *cq_head_;
+  unsigned *cq_tail_;
+  unsigned *cq_mask_;
+  struct io_uring_cqe *cqes_;
+  bool skip_poll_cqe_;        // polls complete silently on success
+
+  // buffer ring, [head_, head_ + count_) hold data, the next one is in flight
+  uint8_t *buffers_;
+  size_t length_[BUFFER_COUNT];
+  size_t offset_;
+  int head_;
+  int count_;
+  bool inflight_;
+
+  // Disable copy constructors
+  UringReader(const UringReader &);
+  UringReader &operator=(const UringReader &);
+};
+
+}
+
+#endif // SERIAL_IMPL_UNIX_URING_H
+
+#endif // defined(__linux__) && defined(YDLIDAR_WITH_IO_URING)
@@ -960,6 +960,18 @@ uint32_t Serial::SerialImpl::getByteTime() {
   return byte_time_ns_;
 }
 
+int Serial::SerialImpl::setLowLatency(bool /*enable*/) {
+  return low_latency_none;
+}
+
+int Serial::SerialImpl::getLowLatency() const {
+  return low_latency_none;
+}
+
+int Serial::SerialImpl::getReadFd() const {
+  return -1;
+}
+
 
 int Serial::SerialImpl::readLock() {
   if (WaitForSingleObject(read_mutex, INFINITE) != WAIT_OBJECT_0) {
@@ -79,6 +79,12 @@ class Serial::SerialImpl {
 
   uint32_t getByteTime();
 
+  int setLowLatency(bool enable);
+
+  int getLowLatency() const;
+
+  int getReadFd() const;
+
   void setPort(const string &port);
 
   string getPort() const;
@@ -0,0 +1,265 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, EAIBOT, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include "lidar_manager.h"
+#include "ydlidar_driver.h"
+#include "common.h"
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#define HAVE_EPOLL 1
+#endif
+
+namespace ydlidar {
+
+LidarManager::LidarManager()
+  : epoll_fd(-1), wakeup_fd(-1), running(false) {
+#ifdef HAVE_EPOLL
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+  if (epoll_fd != -1 && wakeup_fd != -1) {
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &event);
+  }
+
+#endif
+}
+
+LidarManager::~LidarManager() {
+  {
+    ScopedLocker l(_lock);
+
+    //their stop() must not call back into this manager
+    for (size_t i = 0; i < drivers.size(); i++) {
+      drivers[i]->setLidarManager(NULL);
+    }
+
+    drivers.clear();
+  }
+
+#ifdef HAVE_EPOLL
+
+  if (running) {
+    running = false;
+    uint64_t value = 1;
+
+    if (write(wakeup_fd, &value, sizeof(value)) < 0) {
+    }
+
+    _thread.join();
+  }
+
+  if (wakeup_fd != -1) {
+    close(wakeup_fd);
+  }
+
+  if (epoll_fd != -1) {
+    close(epoll_fd);
+  }
+
+#endif
+}
+
+bool LidarManager::add(YDlidarDriver *driver) {
+#ifdef HAVE_EPOLL
+  int fd = driver->getReadFd();
+
+  if (epoll_fd == -1 || wakeup_fd == -1 || fd == -1) {
+    return false;
+  }
+
+  ScopedLocker l(_lock);
+
+  if (std::find(drivers.begin(), drivers.end(), driver) != drivers.end()) {
+    return true;
+  }
+
+  epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.ptr = driver;
+
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1) {
+    return false;
+  }
+
+  drivers.push_back(driver);
+
+  if (!running) {
+    running = true;
+    _thread = CLASS_THREAD(LidarManager, runReactor);
+
+    if (_thread.getHandle() == 0) {
+      running = false;
+      epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, &event);
+      drivers.pop_back();
+      return false;
+    }
+  }
+
+  return true;
+#else
+  UNUSED(driver);
+  return false;
+#endif
+}
+
+void LidarManager::remove(YDlidarDriver *driver) {
+  ScopedLocker l(_lock);
+  std::vector<YDlidarDriver *>::iterator it = std::find(drivers.begin(),
+      drivers.end(), driver);
+
+  if (it == drivers.end()) {
+    return;
+  }
+
+#ifdef HAVE_EPOLL
+  int fd = driver->getReadFd();
+
+  if (fd != -1) {
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, &event);
+  }
+
+#endif
+  drivers.erase(it);
+}
+
+size_t LidarManager::size() {
+  ScopedLocker l(_lock);
+  return drivers.size();
+}
+
+int LidarManager::runReactor() {
+#ifdef HAVE_EPOLL
+  epoll_event events[MAX_EVENTS];
+  uint32_t last_tick = getms();
+  bool wait_failed = false;
+
+  while (running) {
+    int n = epoll_wait(epoll_fd, events, MAX_EVENTS, REACTOR_TICK);
+
+    //keep running on the tick below, exiting would leave running set and
+    //every lidar added later unpolled
+    if (n < 0) {
+      if (errno != EINTR) {
+        if (!wait_failed) {
+          fprintf(stderr, "[YDLIDAR ERROR] epoll_wait failed: %s\n",
+                  strerror(errno));
+          fflush(stderr);
+        }
+
+        wait_failed = true;
+        delay(REACTOR_TICK);
+      }
+
+      n = 0;
+    } else {
+      wait_failed = false;
+    }
+
+    ScopedLocker l(_lock);
+    std::vector<YDlidarDriver *> failed;
+
+    for (int i = 0; i < n; i++) {
+      YDlidarDriver *driver = static_cast<YDlidarDriver *>(events[i].data.ptr);
+
+      if (!driver) {
+        uint64_t value;
+
+        if (read(wakeup_fd, &value, sizeof(value)) < 0) {
+        }
+
+        continue;
+      }
+
+      //removed while we were waiting
+      if (std::find(drivers.begin(), drivers.end(), driver) == drivers.end()) {
+        continue;
+      }
+
+      //level-triggered, a hung up tty would be ready until the timeout
+      if (!IS_OK(driver->pollScanData(events[i].events &
+                                      (EPOLLHUP | EPOLLERR)))) {
+        failed.push_back(driver);
+      }
+    }
+
+    //receive timeouts are detected by polling idle lidars as well
+    if (getms() - last_tick >= REACTOR_TICK) {
+      last_tick = getms();
+
+      for (size_t i = 0; i < drivers.size(); i++) {
+        if (!IS_OK(drivers[i]->pollScanData())) {
+          failed.push_back(drivers[i]);
+        }
+      }
+    }
+
+    //a failed lidar has stopped scanning, stop watching it
+    for (size_t i = 0; i < failed.size(); i++) {
+      std::vector<YDlidarDriver *>::iterator it = std::find(drivers.begin(),
+          drivers.end(), failed[i]);
+
+      if (it == drivers.end()) {
+        continue;
+      }
+
+      int fd = failed[i]->getReadFd();
+
+      if (fd != -1) {
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, &event);
+      }
+
+      drivers.erase(it);
+    }
+  }
+
+#endif
+  return 0;
+}
+
+}// namespace ydlidar
@@ -84,6 +84,18 @@ size_t Serial::available() {
   return pimpl_->available();
 }
 
+int Serial::setLowLatency(bool enable) {
+  return pimpl_->setLowLatency(enable);
+}
+
+int Serial::getLowLatency() const {
+  return pimpl_->getLowLatency();
+}
+
+int Serial::getReadFd() const {
+  return pimpl_->getReadFd();
+}
+
 bool Serial::waitReadable() {
   serial::Timeout timeout(pimpl_->getTimeout());
   return pimpl_->waitReadable(timeout.read_timeout_constant);
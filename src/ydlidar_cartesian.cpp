@@ -0,0 +1,135 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2020, EAIBOT, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include "ydlidar_cartesian.h"
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define YDLIDAR_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace ydlidar {
+
+#if defined(YDLIDAR_HAS_SSE2)
+namespace {
+inline __m128 splat(float value) {
+  return _mm_set1_ps(value);
+}
+
+//sin and cos of 4 angles, reduced to [-pi/4, pi/4] by octant and evaluated
+//with the cephes sinf/cosf polynomials
+inline void sincos4(__m128 x, __m128 &sin_out, __m128 &cos_out) {
+  const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+  __m128 sin_sign = _mm_and_ps(x, sign_mask);
+  x = _mm_andnot_ps(sign_mask, x);
+
+  //octant j, rounded up to even so the remainder is centred on 0
+  __m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, splat(1.27323954473516f)));
+  j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+  __m128 y = _mm_cvtepi32_ps(j);
+
+  sin_sign = _mm_xor_ps(sin_sign, _mm_castsi128_ps(_mm_slli_epi32(
+                          _mm_and_si128(j, _mm_set1_epi32(4)), 29)));
+  __m128 cos_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(
+                                       _mm_sub_epi32(j, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+  //octants 1, 2, 5, 6 swap the sin and cos polynomials
+  __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(
+                                   _mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()));
+
+  //x - j * pi/4 in extended precision
+  x = _mm_add_ps(x, _mm_mul_ps(y, splat(-0.78515625f)));
+  x = _mm_add_ps(x, _mm_mul_ps(y, splat(-2.4187564849853515625e-4f)));
+  x = _mm_add_ps(x, _mm_mul_ps(y, splat(-3.77489497744594108e-8f)));
+  __m128 z = _mm_mul_ps(x, x);
+
+  __m128 c = splat(2.443315711809948e-5f);
+  c = _mm_add_ps(_mm_mul_ps(c, z), splat(-1.388731625493765e-3f));
+  c = _mm_add_ps(_mm_mul_ps(c, z), splat(4.166664568298827e-2f));
+  c = _mm_mul_ps(_mm_mul_ps(c, z), z);
+  c = _mm_sub_ps(c, _mm_mul_ps(z, splat(0.5f)));
+  c = _mm_add_ps(c, splat(1.f));
+
+  __m128 s = splat(-1.9515295891e-4f);
+  s = _mm_add_ps(_mm_mul_ps(s, z), splat(8.3321608736e-3f));
+  s = _mm_add_ps(_mm_mul_ps(s, z), splat(-1.6666654611e-1f));
+  s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, z), x), x);
+
+  sin_out = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c)),
+                       sin_sign);
+  cos_out = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s)),
+                       cos_sign);
+}
+}
+#endif
+
+void polarUnitVectors(const float *angle, size_t count, float *cos_out,
+                      float *sin_out) {
+  size_t i = 0;
+#if defined(YDLIDAR_HAS_SSE2)
+
+  for (; i + 4 <= count; i += 4) {
+    __m128 s, c;
+    sincos4(_mm_loadu_ps(angle + i), s, c);
+    _mm_storeu_ps(cos_out + i, c);
+    _mm_storeu_ps(sin_out + i, s);
+  }
+
+#endif
+
+  for (; i < count; i++) {
+    cos_out[i] = cosf(angle[i]);
+    sin_out[i] = sinf(angle[i]);
+  }
+}
+
+void polarToCartesian(const float *range, const float *cos_table,
+                      const float *sin_table, size_t count, float *x, float *y) {
+  size_t i = 0;
+#if defined(YDLIDAR_HAS_SSE2)
+
+  for (; i + 4 <= count; i += 4) {
+    __m128 r = _mm_loadu_ps(range + i);
+    _mm_storeu_ps(x + i, _mm_mul_ps(r, _mm_loadu_ps(cos_table + i)));
+    _mm_storeu_ps(y + i, _mm_mul_ps(r, _mm_loadu_ps(sin_table + i)));
+  }
+
+#endif
+
+  for (; i < count; i++) {
+    x[i] = range[i] * cos_table[i];
+    y[i] = range[i] * sin_table[i];
+  }
+}
+
+}
@@ -0,0 +1,64 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2020, EAIBOT, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#pragma once
+#include <stddef.h>
+
+namespace ydlidar {
+
+/*!
+ * @brief 计算角度的单位向量 \n
+ * @param[in] angle     角度数组 [rad]
+ * @param[in] count     点数
+ * @param[out] cos_out  cos(angle)
+ * @param[out] sin_out  sin(angle)
+ * @note x86平台使用SSE2多项式实现, 每次计算4个角度, 与sinf/cosf的误差小于1e-7
+ */
+void polarUnitVectors(const float *angle, size_t count, float *cos_out,
+                      float *sin_out);
+
+/*!
+ * @brief 极坐标转直角坐标 \n
+ * x = range * cos, y = range * sin
+ * @param[in] range      距离数组 [m]
+ * @param[in] cos_table  单位向量x分量, 见::polarUnitVectors
+ * @param[in] sin_table  单位向量y分量
+ * @param[in] count      点数
+ * @param[out] x         x坐标 [m]
+ * @param[out] y         y坐标 [m]
+ * @note x86平台使用SSE2实现
+ */
+void polarToCartesian(const float *range, const float *cos_table,
+                      const float *sin_table, size_t count, float *x, float *y);
+
+}
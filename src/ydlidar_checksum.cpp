@@ -0,0 +1,249 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2020, EAIBOT, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include "ydlidar_checksum.h"
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define YDLIDAR_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(YDLIDAR_HAS_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define YDLIDAR_HAS_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace ydlidar {
+
+namespace {
+
+typedef PackageCheckSumFunc CheckSumFunc;
+
+uint16_t checkSumScalar(const uint8_t *data, size_t count, int sample_bytes) {
+  uint8_t low = 0;
+  uint8_t high = 0;
+
+  if (sample_bytes == 3) {
+    for (size_t i = 0; i < count; i++, data += 3) {
+      low ^= data[0] ^ data[1];
+      high ^= data[2];
+    }
+  } else {
+    for (size_t i = 0; i < count; i++, data += 2) {
+      low ^= data[0];
+      high ^= data[1];
+    }
+  }
+
+  return (uint16_t)(low | (high << 8));
+}
+
+#if defined(YDLIDAR_HAS_SSE2)
+//3 vectors keep the 3-byte sample phase aligned with the vector lanes
+const size_t SSE2_BLOCK = 3 * sizeof(__m128i);
+
+uint16_t checkSumFoldSSE2(const uint8_t *data, size_t count, int sample_bytes,
+                          __m128i acc0, __m128i acc1, __m128i acc2) {
+  size_t blocks = count * sample_bytes / SSE2_BLOCK;
+
+  for (size_t i = 0; i < blocks; i++) {
+    const __m128i *ptr = reinterpret_cast<const __m128i *>(data + i * SSE2_BLOCK);
+    acc0 = _mm_xor_si128(acc0, _mm_loadu_si128(ptr));
+    acc1 = _mm_xor_si128(acc1, _mm_loadu_si128(ptr + 1));
+    acc2 = _mm_xor_si128(acc2, _mm_loadu_si128(ptr + 2));
+  }
+
+  uint8_t lanes[SSE2_BLOCK];
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), acc0);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes) + 1, acc1);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes) + 2, acc2);
+
+  //block size is a multiple of both sample sizes
+  size_t done = blocks * SSE2_BLOCK / sample_bytes;
+  return checkSumScalar(lanes, SSE2_BLOCK / sample_bytes, sample_bytes) ^
+         checkSumScalar(data + blocks * SSE2_BLOCK, count - done, sample_bytes);
+}
+
+uint16_t checkSumSSE2(const uint8_t *data, size_t count, int sample_bytes) {
+  return checkSumFoldSSE2(data, count, sample_bytes, _mm_setzero_si128(),
+                          _mm_setzero_si128(), _mm_setzero_si128());
+}
+#endif
+
+#if defined(YDLIDAR_HAS_AVX2)
+__attribute__((target("avx2")))
+uint16_t checkSumAVX2(const uint8_t *data, size_t count, int sample_bytes) {
+  const size_t block = 3 * sizeof(__m256i);
+  size_t blocks = count * sample_bytes / block;
+  __m256i acc0 = _mm256_setzero_si256();
+  __m256i acc1 = _mm256_setzero_si256();
+  __m256i acc2 = _mm256_setzero_si256();
+
+  for (size_t i = 0; i < blocks; i++) {
+    const __m256i *ptr = reinterpret_cast<const __m256i *>(data + i * block);
+    acc0 = _mm256_xor_si256(acc0, _mm256_loadu_si256(ptr));
+    acc1 = _mm256_xor_si256(acc1, _mm256_loadu_si256(ptr + 1));
+    acc2 = _mm256_xor_si256(acc2, _mm256_loadu_si256(ptr + 2));
+  }
+
+  //fold the 96 byte state to 48 bytes, offsets k and k + 48 share a phase
+  __m128i x0 = _mm_xor_si128(_mm256_castsi256_si128(acc0),
+                             _mm256_extracti128_si256(acc1, 1));
+  __m128i x1 = _mm_xor_si128(_mm256_extracti128_si256(acc0, 1),
+                             _mm256_castsi256_si128(acc2));
+  __m128i x2 = _mm_xor_si128(_mm256_castsi256_si128(acc1),
+                             _mm256_extracti128_si256(acc2, 1));
+  size_t done = blocks * block / sample_bytes;
+  //avoid the AVX to SSE transition penalty in the SSE2 tail
+  _mm256_zeroupper();
+  return checkSumFoldSSE2(data + blocks * block, count - done, sample_bytes, x0,
+                          x1, x2);
+}
+#endif
+
+#if defined(YDLIDAR_HAS_SSE2)
+inline size_t lowestSetBit(int mask) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+CheckSumFunc selectCheckSum() {
+#if defined(YDLIDAR_HAS_AVX2)
+
+  if (__builtin_cpu_supports("avx2")) {
+    return checkSumAVX2;
+  }
+
+#endif
+#if defined(YDLIDAR_HAS_SSE2)
+  return checkSumSSE2;
+#else
+  return checkSumScalar;
+#endif
+}
+
+}
+
+uint16_t packageSampleCheckSum(const uint8_t *data, size_t count,
+                               int sample_bytes) {
+  //short packages are not worth a vector pass
+  if (count < 64) {
+    return checkSumScalar(data, count, sample_bytes);
+  }
+
+  static const CheckSumFunc checkSumImpl = selectCheckSum();
+  return checkSumImpl(data, count, sample_bytes);
+}
+
+PackageCheckSumFunc packageSampleCheckSumImpl(int impl) {
+  switch (impl) {
+    case CHECKSUM_SCALAR:
+      return checkSumScalar;
+#if defined(YDLIDAR_HAS_SSE2)
+
+    case CHECKSUM_SSE2:
+      return checkSumSSE2;
+#endif
+#if defined(YDLIDAR_HAS_AVX2)
+
+    case CHECKSUM_AVX2:
+      if (__builtin_cpu_supports("avx2")) {
+        return checkSumAVX2;
+      }
+
+      break;
+#endif
+
+    default:
+      break;
+  }
+
+  return NULL;
+}
+
+size_t findPackageHeader(const uint8_t *data, size_t size, uint16_t header) {
+  const uint8_t low = header & 0xFF;
+  const uint8_t high = header >> 8;
+  size_t pos = 0;
+
+#if defined(YDLIDAR_HAS_SSE2)
+  const __m128i low_bytes = _mm_set1_epi8((char)low);
+  const __m128i high_bytes = _mm_set1_epi8((char)high);
+
+  //the second load reads one byte ahead
+  for (; pos + sizeof(__m128i) < size; pos += sizeof(__m128i)) {
+    __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+    __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i *>
+                                     (data + pos + 1));
+    int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, low_bytes),
+                                 _mm_cmpeq_epi8(second, high_bytes)));
+
+    if (mask) {
+      return pos + lowestSetBit(mask);
+    }
+  }
+
+#endif
+
+  while (pos < size) {
+    const uint8_t *found = static_cast<const uint8_t *>(memchr(data + pos, low,
+                           size - pos));
+
+    if (!found) {
+      return size;
+    }
+
+    pos = found - data;
+
+    if (pos + 1 == size || data[pos + 1] == high) {
+      return pos;
+    }
+
+    pos++;
+  }
+
+  return size;
+}
+
+}
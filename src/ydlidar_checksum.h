@@ -0,0 +1,84 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2020, EAIBOT, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#pragma once
+#include "v8stdint.h"
+#include <stddef.h>
+
+namespace ydlidar {
+
+/*!
+ * @brief 计算数据包采样点的异或校验和 \n
+ * 采样点按16位小端数据异或, 带信号质量协议中信号质量字节作为16位的低字节参与异或.
+ * @param[in] data          采样点数据
+ * @param[in] count         采样点数
+ * @param[in] sample_bytes  每个采样点字节数, 2(node_packages)或3(node_package)
+ * @return 采样点部分的校验和
+ * @note 根据CPU支持情况选择AVX2, SSE2或标量实现
+ */
+uint16_t packageSampleCheckSum(const uint8_t *data, size_t count,
+                               int sample_bytes);
+
+//! ::packageSampleCheckSum的实现
+typedef enum {
+  CHECKSUM_SCALAR = 0,//!< 标量
+  CHECKSUM_SSE2 = 1,//!< SSE2
+  CHECKSUM_AVX2 = 2,//!< AVX2
+  CHECKSUM_Tail,
+} CheckSumImplID;
+
+//! 参数与::packageSampleCheckSum相同
+typedef uint16_t (*PackageCheckSumFunc)(const uint8_t *data, size_t count,
+                                        int sample_bytes);
+
+/*!
+ * @brief 获取指定的采样点校验和实现, 不按采样点数选择实现 \n
+ * 用于对比各实现的结果和性能, 见tests/checksum_bench.cpp
+ * @param[in] impl  实现, 见::CheckSumImplID
+ * @return 编译器或CPU不支持该实现时返回NULL
+ */
+PackageCheckSumFunc packageSampleCheckSumImpl(int impl);
+
+/*!
+ * @brief 查找数据包帧头 \n
+ * 帧头按小端存放, 即header的低字节在前. 缓冲区末尾单独的低字节也算作候选位置,
+ * 以便等待下一个字节到达.
+ * @param[in] data    接收数据
+ * @param[in] size    数据大小
+ * @param[in] header  帧头, 例如PH
+ * @return 第一个候选帧头的偏移, 没有候选时返回size
+ * @note SSE2下每次比较16个字节, 否则用memchr查找低字节
+ */
+size_t findPackageHeader(const uint8_t *data, size_t size, uint16_t header);
+
+}
@@ -0,0 +1,103 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2020, EAIBOT, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include "ydlidar_decoder.h"
+
+namespace ydlidar {
+
+namespace {
+
+/*!
+ * Decoder for one protocol variant.
+ * Intensity: 3 byte samples (quality, distance), otherwise 2 byte distances.
+ * Tof: no distance dependent angle correction and default quality.
+ * The octave models only differ in the correction table scale, which
+ * updateAngleCorrectTable already bakes in.
+ */
+template<bool Intensity, bool Tof>
+struct Decoder {
+  static void decode(const uint8_t *samples, size_t count,
+                     uint16_t first_angle, float interval,
+                     const int16_t *correct_table,
+                     const node_sample &package_node,
+                     node_sample *nodebuffer) {
+    const int sample_bytes = Intensity ? 3 : 2;
+
+    for (size_t i = 0; i < count; i++) {
+      const uint8_t *sample = samples + i * sample_bytes;
+      node_sample &node = nodebuffer[i];
+      node = package_node;
+
+      if (Intensity) {
+        uint16_t distance = sample[1] | (sample[2] << 8);
+        node.sync_quality = ((uint16_t)((distance & 0x03) <<
+                                        LIDAR_RESP_MEASUREMENT_ANGLE_SAMPLE_SHIFT) | sample[0]);
+        node.distance_q2 = distance & 0xfffc;
+      } else {
+        node.distance_q2 = sample[0] | (sample[1] << 8);
+
+        if (!Tof) {
+          node.sync_quality = ((uint16_t)(0xfc | (node.distance_q2 & 0x0003))) <<
+                              LIDAR_RESP_MEASUREMENT_QUALITY_SHIFT;
+        }
+      }
+
+      float sampleAngle = first_angle + interval * i;
+
+      if (!Tof) {
+        sampleAngle += correct_table[node.distance_q2];
+      }
+
+      if (sampleAngle < 0) {
+        sampleAngle += 23040;
+      } else if (sampleAngle > 23040) {
+        sampleAngle -= 23040;
+      }
+
+      node.angle_q6_checkbit = (((uint16_t)sampleAngle) <<
+                                LIDAR_RESP_MEASUREMENT_ANGLE_SHIFT) + LIDAR_RESP_MEASUREMENT_CHECKBIT;
+    }
+  }
+};
+
+}
+
+PackageDecoder selectPackageDecoder(bool intensity, bool tof) {
+  if (intensity) {
+    return tof ? Decoder<true, true>::decode : Decoder<true, false>::decode;
+  }
+
+  return tof ? Decoder<false, true>::decode : Decoder<false, false>::decode;
+}
+
+}
@@ -32,8 +32,11 @@
 *  POSSIBILITY OF SUCH DAMAGE.
 *********************************************************************/
 #include "ydlidar_driver.h"
+#include "lidar_manager.h"
 #include "common.h"
+#include "ydlidar_checksum.h"
 #include <math.h>
+#include <algorithm>
 using namespace impl;
 
 namespace ydlidar {
@@ -48,13 +51,13 @@ YDlidarDriver::YDlidarDriver():
   isAutoconnting      = false;
   m_baudrate          = 230400;
   isSupportMotorDtrCtrl  = true;
-  scan_node_count     = 0;
   sample_rate         = 5000;
   m_PointTime         = 1e9 / 5000;
   trans_delay         = 0;
   scan_frequence      = 0;
   m_sampling_rate     = -1;
   model               = -1;
+  model_info          = &lidarModelInfo(model);
   retryCount          = 0;
   has_device_header   = false;
   m_SingleChannel     = false;
@@ -62,15 +65,6 @@ YDlidarDriver::YDlidarDriver():
 
   //解析参数
   PackageSampleBytes  = 2;
-  IntervalSampleAngle = 0.0;
-  FirstSampleAngle    = 0;
-  LastSampleAngle     = 0;
-  CheckSum            = 0;
-  CheckSumCal         = 0;
-  SampleNumlAndCTCal  = 0;
-  LastSampleAngleCal  = 0;
-  CheckSumResult      = true;
-  Valu8Tou16          = 0;
 
   last_device_byte    = 0x00;
   asyncRecvPos        = 0;
@@ -81,12 +75,35 @@ YDlidarDriver::YDlidarDriver():
   get_device_health_success = false;
   get_device_info_success = false;
 
-  package_Sample_Index = 0;
   IntervalSampleAngle_LastPackage = 0.0;
-  globalRecvBuffer = new uint8_t[sizeof(node_packages)];
-  scan_node_buf = new node_info[MAX_SCAN_NODES];
+  angleCorrectTable = NULL;
+  angleCorrectScale = 0;
+  package_decoder = selectPackageDecoder(m_intensities,
+                                         isTOFLidar(m_LidarType));
+  globalRecvBuffer = new uint8_t[MAX_RECV_BUFFER_SIZE];
+  globalRecvPos = 0;
+  globalRecvSize = 0;
+  m_ScanQueueSize = 1;
+  m_ScanQueuePolicy = QUEUE_DROP_OLDEST;
+  m_LowLatency = false;
+  m_WakeupRate = 0;
+  scan_queue = new BufferQueue<ScanBuffer>(m_ScanQueueSize);
+  scan_queue_overflow = 0;
   package_index = 0;
   has_package_error = false;
+  cache_scan = NULL;
+  cache_count = 0;
+  m_AscendScan = false;
+  ascend_head = new node_sample[MAX_SCAN_NODES];
+  ascend_head_count = 0;
+  ascend_last_angle = -1;
+  lidar_manager = NULL;
+  lidar_managed = false;
+  last_data_time = 0;
+  wait_scan_start = false;
+  last_wakeup_time = 0;
+  scan_published = NULL;
+  scan_published_context = NULL;
 }
 
 YDlidarDriver::~YDlidarDriver() {
@@ -95,6 +112,12 @@ YDlidarDriver::~YDlidarDriver() {
   }
 
   isAutoReconnect = false;
+
+  if (lidar_managed) {
+    lidar_manager->remove(this);
+    lidar_managed = false;
+  }
+
   _thread.join();
 
   ScopedLocker lk(_serial_lock);
@@ -116,9 +139,19 @@ YDlidarDriver::~YDlidarDriver() {
     globalRecvBuffer = NULL;
   }
 
-  if (scan_node_buf) {
-    delete[] scan_node_buf;
-    scan_node_buf = NULL;
+  if (ascend_head) {
+    delete[] ascend_head;
+    ascend_head = NULL;
+  }
+
+  if (scan_queue) {
+    delete scan_queue;
+    scan_queue = NULL;
+  }
+
+  if (angleCorrectTable) {
+    delete[] angleCorrectTable;
+    angleCorrectTable = NULL;
   }
 }
 
@@ -134,6 +167,7 @@ result_t YDlidarDriver::connect(const char *port_path, uint32_t baudrate) {
 
   {
     ScopedLocker l(_lock);
+    _serial->setLowLatency(m_LowLatency);
 
     if (!_serial->open()) {
       return RESULT_FAIL;
@@ -143,6 +177,15 @@ result_t YDlidarDriver::connect(const char *port_path, uint32_t baudrate) {
 
   }
 
+  if (m_LowLatency) {
+    int applied = _serial->getLowLatency();
+    printf("[YDLIDAR INFO] Low latency serial: termios %s, async %s, "
+           "usb latency timer %s\n",
+           (applied & serial::low_latency_termios) ? "ok" : "failed",
+           (applied & serial::low_latency_async) ? "ok" : "failed",
+           (applied & serial::low_latency_usb_timer) ? "ok" : "failed");
+  }
+
   stopScan();
   delay(100);
   clearDTR();
@@ -182,6 +225,8 @@ void YDlidarDriver::flushSerial() {
     _serial->read(len);
   }
 
+  globalRecvPos = 0;
+  globalRecvSize = 0;
   delay(20);
 }
 
@@ -213,8 +258,16 @@ void YDlidarDriver::disableDataGrabbing() {
     if (isScanning) {
       isScanning = false;
       _dataEvent.set();
+      _queueEvent.set();
     }
   }
+
+  if (lidar_managed) {
+    lidar_manager->remove(this);
+    lidar_managed = false;
+    return;
+  }
+
   _thread.join();
 }
 
@@ -452,26 +505,25 @@ result_t YDlidarDriver::checkAutoConnecting() {
 }
 
 int YDlidarDriver::cacheScanData() {
-  node_info      local_buf[128];
-  size_t         count = 128;
-  node_info      local_scan[MAX_SCAN_NODES];
-  size_t         scan_count = 0;
+  node_sample    local_buf[PackageSampleMaxLngth];
+  size_t         count = PackageSampleMaxLngth;
+  scan_info      local_info;
   result_t       ans = RESULT_FAIL;
-  memset(local_scan, 0, sizeof(local_scan));
+  resetScanCache();
 
   if (m_SingleChannel) {
     waitDevicePackage();
   }
 
   flushSerial();
-  waitScanData(local_buf, count);
+  waitScanData(local_buf, count, local_info);
 
   int timeout_count   = 0;
   retryCount = 0;
 
   while (isScanning) {
-    count = 128;
-    ans = waitScanData(local_buf, count);
+    count = PackageSampleMaxLngth;
+    ans = waitScanData(local_buf, count, local_info);
 
     if (!IS_OK(ans)) {
       if (IS_FAIL(ans) || timeout_count > DEFAULT_TIMEOUT_COUNT) {
@@ -487,7 +539,7 @@ int YDlidarDriver::cacheScanData() {
 
           if (IS_OK(ans)) {
             timeout_count = 0;
-            local_scan[0].sync_flag = Node_NotSync;
+            cache_scan->nodes[0].sync_flag = Node_NotSync;
           } else {
             isScanning = false;
             return RESULT_FAIL;
@@ -495,7 +547,7 @@ int YDlidarDriver::cacheScanData() {
         }
       } else {
         timeout_count++;
-        local_scan[0].sync_flag = Node_NotSync;
+        cache_scan->nodes[0].sync_flag = Node_NotSync;
         fprintf(stderr, "timout count: %d\n", timeout_count);
         fflush(stderr);
       }
@@ -504,33 +556,193 @@ int YDlidarDriver::cacheScanData() {
       retryCount = 0;
     }
 
+    cacheScanNodes(local_buf, count, local_info);
+  }
+
+  isScanning = false;
+
+  return RESULT_OK;
+}
+
+void YDlidarDriver::resetScanCache() {
+  cache_scan = &scan_queue->writeBuffer();
+  cache_count = 0;
+  cache_scan->nodes[0].sync_flag = Node_NotSync;
+  cache_scan->info.debug_mask = 0;
+  ascend_head_count = 0;
+  ascend_last_angle = -1;
+}
 
-    for (size_t pos = 0; pos < count; ++pos) {
-      if (local_buf[pos].sync_flag & LIDAR_RESP_MEASUREMENT_SYNCBIT) {
-        if ((local_scan[0].sync_flag & LIDAR_RESP_MEASUREMENT_SYNCBIT)) {
-          _lock.lock();//timeout lock, wait resource copy
-          local_scan[0].stamp = local_buf[pos].stamp;
-          local_scan[0].scan_frequence = local_buf[pos].scan_frequence;
-          memcpy(scan_node_buf, local_scan, scan_count * sizeof(node_info));
-          scan_node_count = scan_count;
-          _dataEvent.set();
-          _lock.unlock();
+void YDlidarDriver::cacheScanNodes(const node_sample *nodes, size_t count,
+                                   const scan_info &info) {
+  //debug packages are the normal packages following the zero packet
+  //(package_index restarts at CT_RingStart), they never start a scan and
+  //belong to the one being collected
+  for (int i = 0; i < (int)_countof(info.debug_info); i++) {
+    if (info.debug_mask & (1 << i)) {
+      cache_scan->info.debug_info[i] = info.debug_info[i];
+    }
+  }
+
+  cache_scan->info.debug_mask |= info.debug_mask;
+
+  for (size_t pos = 0; pos < count; ++pos) {
+    if (nodes[pos].sync_flag & LIDAR_RESP_MEASUREMENT_SYNCBIT) {
+      const node_sample &first = ascend_head_count ? ascend_head[0] :
+                                 cache_scan->nodes[0];
+
+      if ((first.sync_flag & LIDAR_RESP_MEASUREMENT_SYNCBIT)) {
+        //ascending scan: the nodes before the 360 to 0 wrap go last
+        size_t size = min(ascend_head_count,
+                          _countof(cache_scan->nodes) - cache_count);
+        memcpy(cache_scan->nodes + cache_count, ascend_head,
+               size * sizeof(node_sample));
+        cache_scan->info.stamp = info.stamp;
+        cache_scan->info.scan_frequence = info.scan_frequence;
+        cache_scan->count = cache_count + size;
+        publishScanData();
+        cache_scan = &scan_queue->writeBuffer();
+      }
+
+      cache_count = 0;
+      cache_scan->info.debug_mask = 0;
+      ascend_head_count = 0;
+      ascend_last_angle = -1;
+    }
+
+    //zero-distance nodes are skipped, failed packages carry no angle
+    if (m_AscendScan && nodes[pos].distance_q2 != 0) {
+      int angle = nodes[pos].angle_q6_checkbit >> LIDAR_RESP_MEASUREMENT_ANGLE_SHIFT;
+
+      //the first drop of more than 180 degrees is the 360 to 0 wrap,
+      //the nodes before it are kept aside until the scan is published
+      if (ascend_head_count == 0 && ascend_last_angle - angle > 180 * 64) {
+        size_t split = cache_count;
+
+        //zero-distance nodes already past the wrap stay after it
+        while (split > 0 && cache_scan->nodes[split - 1].distance_q2 == 0 &&
+               ascend_last_angle - (cache_scan->nodes[split - 1].angle_q6_checkbit >>
+                                    LIDAR_RESP_MEASUREMENT_ANGLE_SHIFT) > 180 * 64) {
+          split--;
         }
 
-        scan_count = 0;
+        memcpy(ascend_head, cache_scan->nodes, split * sizeof(node_sample));
+        ascend_head_count = split;
+        cache_count -= split;
+        memmove(cache_scan->nodes, cache_scan->nodes + split,
+                cache_count * sizeof(node_sample));
+      }
+
+      ascend_last_angle = angle;
+    }
+
+    cache_scan->nodes[cache_count++] = nodes[pos];
+
+    if (cache_count == _countof(cache_scan->nodes)) {
+      cache_count -= 1;
+    }
+  }
+}
+
+result_t YDlidarDriver::pollScanData(bool hangup) {
+  node_sample local_buf[PackageSampleMaxLngth];
+  scan_info   local_info;
+  size_t      recvSize = 0;
+
+  if (!isScanning) {
+    return RESULT_FAIL;
+  }
+
+  do {
+    //move the incomplete package to the front of the buffer
+    if (globalRecvPos > 0) {
+      globalRecvSize -= globalRecvPos;
+      memmove(globalRecvBuffer, globalRecvBuffer + globalRecvPos, globalRecvSize);
+      globalRecvPos = 0;
+    }
+
+    recvSize = min(_serial->available(),
+                   (size_t)(MAX_RECV_BUFFER_SIZE - globalRecvSize));
+
+    if (recvSize > 0) {
+      if (IS_FAIL(getData(globalRecvBuffer + globalRecvSize, recvSize))) {
+        break;
       }
 
-      local_scan[scan_count++] = local_buf[pos];
+      globalRecvSize += recvSize;
+      last_data_time = getms();
+    }
+
+    while (globalRecvPos < globalRecvSize) {
+      size_t used = 0;
+      size_t remain = 0;
+      size_t count = 0;
+      local_info.stamp = 0;
+      local_info.scan_frequence = 0;
+      local_info.debug_mask = 0;
+      result_t ans = parsePackage(globalRecvBuffer + globalRecvPos,
+                                  globalRecvSize - globalRecvPos, used, remain,
+                                  local_buf, count, local_info);
+      globalRecvPos += used;
 
-      if (scan_count == _countof(local_scan)) {
-        scan_count -= 1;
+      if (!IS_OK(ans)) {
+        break;
+      }
+
+      bool sync = count > 0 &&
+                  (local_buf[0].sync_flag & LIDAR_RESP_MEASUREMENT_SYNCBIT);
+
+      //like the scan thread, drop everything up to the first zero packet
+      if (wait_scan_start) {
+        wait_scan_start = !sync;
+        continue;
       }
+
+      if (sync) {
+        local_info.stamp = syncPackageDelay();
+      }
+
+      cacheScanNodes(local_buf, count, local_info);
     }
+  } while (recvSize > 0 && isScanning);
+
+  if (hangup) {
+    fprintf(stderr, "[YDLIDAR ERROR] %s: serial port hung up, stop scanning\n",
+            serial_port.c_str());
+  } else if (getms() - last_data_time <= DEFAULT_TIMEOUT *
+             (DEFAULT_TIMEOUT_COUNT + 1)) {
+    return RESULT_OK;
+  } else {
+    fprintf(stderr, "[YDLIDAR ERROR] %s: no data, stop scanning\n",
+            serial_port.c_str());
   }
 
+  fflush(stderr);
   isScanning = false;
+  //the reactor drops us on RESULT_FAIL, stop() must not go back to it
+  lidar_managed = false;
+  _dataEvent.set();
+  _queueEvent.set();
+  return RESULT_FAIL;
+}
 
-  return RESULT_OK;
+int YDlidarDriver::getReadFd() const {
+  return _serial ? _serial->getReadFd() : -1;
+}
+
+void YDlidarDriver::setLidarManager(LidarManager *manager) {
+  //LidarManager detaches the lidars still registered when it is destroyed
+  if (manager != lidar_manager) {
+    lidar_managed = false;
+  }
+
+  lidar_manager = manager;
+}
+
+void YDlidarDriver::setScanPublishedCallback(ScanPublishedCallback callback,
+    void *context) {
+  scan_published = callback;
+  scan_published_context = context;
 }
 
 result_t YDlidarDriver::checkDeviceInfo(uint8_t *recvBuffer, uint8_t byte,
@@ -721,348 +933,258 @@ result_t YDlidarDriver::waitDevicePackage(uint32_t timeout) {
 
 }
 
-result_t YDlidarDriver::waitPackage(node_info *node, uint32_t timeout) {
-  int recvPos         = 0;
-  uint32_t startTs    = getms();
-  uint32_t waitTime   = 0;
-  uint8_t  *packageBuffer = (m_intensities) ? (uint8_t *)&package.package_Head :
-                            (uint8_t *)&packages.package_Head;
-  uint8_t  package_Sample_Num         = 0;
-  int32_t  AngleCorrectForDistance    = 0;
-  int  package_recvPos    = 0;
-  uint8_t package_type    = 0;
-
-  if (package_Sample_Index == 0) {
-    recvPos = 0;
-
-    while ((waitTime = getms() - startTs) <= timeout) {
-      size_t remainSize   = PackagePaidBytes - recvPos;
-      size_t recvSize     = 0;
-      result_t ans = waitForData(remainSize, timeout - waitTime, &recvSize);
-
-      if (!IS_OK(ans)) {
-        return ans;
-      }
-
-      if (recvSize > remainSize) {
-        recvSize = remainSize;
-      }
-
-      getData(globalRecvBuffer, recvSize);
-
-      for (size_t pos = 0; pos < recvSize; ++pos) {
-        uint8_t currentByte = globalRecvBuffer[pos];
-
-        switch (recvPos) {
-          case 0:
-            if (currentByte == (PH & 0xFF)) {
-
-            } else {
-              continue;
-            }
-
-            break;
-
-          case 1:
-            CheckSumCal = PH;
-
-            if (currentByte == (PH >> 8)) {
+result_t YDlidarDriver::parsePackage(const uint8_t *data, size_t size,
+                                     size_t &used, size_t &remain,
+                                     node_sample *nodebuffer, size_t &count,
+                                     scan_info &info) {
+  size_t pos = 0;
+  count   = 0;
+  remain  = PackagePaidBytes;
 
-            } else {
-              recvPos = 0;
-              continue;
-            }
-
-            break;
+  while (pos < size) {
+    pos += findPackageHeader(data + pos, size - pos, PH);
 
-          case 2:
-            SampleNumlAndCTCal = currentByte;
-            package_type = currentByte & 0x01;
+    if (pos >= size) {
+      break;
+    }
 
-            if ((package_type == CT_Normal) || (package_type == CT_RingStart)) {
-              if (package_type == CT_RingStart) {
-                scan_frequence = (currentByte & 0xFE) >> 1;
-              }
-            } else {
-              has_package_error = true;
-              recvPos = 0;
-              continue;
-            }
+    if (size - pos < PackagePaidBytes) {
+      remain = PackagePaidBytes - (size - pos);
+      break;
+    }
 
-            break;
+    const node_packages *header = reinterpret_cast<const node_packages *>
+                                  (data + pos);
+    uint8_t  package_CT = header->package_CT;
+    uint8_t  package_Sample_Num = header->nowPackageNum;
+    uint16_t FirstSampleAngleCal = header->packageFirstSampleAngle;
+    uint16_t LastSampleAngleCal = header->packageLastSampleAngle;
 
-          case 3:
-            SampleNumlAndCTCal += (currentByte * 0x100);
-            package_Sample_Num = currentByte;
-            break;
+    if (!(FirstSampleAngleCal & LIDAR_RESP_MEASUREMENT_CHECKBIT) ||
+        !(LastSampleAngleCal & LIDAR_RESP_MEASUREMENT_CHECKBIT) ||
+        package_Sample_Num == 0) {
+      has_package_error = true;
+      pos++;
+      continue;
+    }
 
-          case 4:
-            if (currentByte & LIDAR_RESP_MEASUREMENT_CHECKBIT) {
-              FirstSampleAngle = currentByte;
-            } else {
-              has_package_error = true;
-              recvPos = 0;
-              continue;
-            }
+    size_t package_size = PackagePaidBytes + package_Sample_Num *
+                          PackageSampleBytes;
 
-            break;
-
-          case 5:
-            FirstSampleAngle += currentByte * 0x100;
-            CheckSumCal ^= FirstSampleAngle;
-            FirstSampleAngle = FirstSampleAngle >> 1;
-            break;
-
-          case 6:
-            if (currentByte & LIDAR_RESP_MEASUREMENT_CHECKBIT) {
-              LastSampleAngle = currentByte;
-            } else {
-              has_package_error = true;
-              recvPos = 0;
-              continue;
-            }
+    if (size - pos < package_size) {
+      remain = package_size - (size - pos);
+      break;
+    }
 
-            break;
-
-          case 7:
-            LastSampleAngle = currentByte * 0x100 + LastSampleAngle;
-            LastSampleAngleCal = LastSampleAngle;
-            LastSampleAngle = LastSampleAngle >> 1;
-
-            if (package_Sample_Num == 1) {
-              IntervalSampleAngle = 0;
-            } else {
-              if (LastSampleAngle < FirstSampleAngle) {
-                if ((FirstSampleAngle > 270 * 64) && (LastSampleAngle < 90 * 64)) {
-                  IntervalSampleAngle = (float)((360 * 64 + LastSampleAngle -
-                                                 FirstSampleAngle) / ((
-                                                       package_Sample_Num - 1) * 1.0));
-                  IntervalSampleAngle_LastPackage = IntervalSampleAngle;
-                } else {
-                  IntervalSampleAngle = IntervalSampleAngle_LastPackage;
-                }
-              } else {
-                IntervalSampleAngle = (float)((LastSampleAngle - FirstSampleAngle) / ((
-                                                package_Sample_Num - 1) * 1.0));
-                IntervalSampleAngle_LastPackage = IntervalSampleAngle;
-              }
-            }
+    bool CheckSumResult = (packageCheckSum(data + pos) == header->checkSum);
 
-            break;
+    if (!CheckSumResult) {
+      has_package_error = true;
 
-          case 8:
-            CheckSum = currentByte;
-            break;
+      //a header inside corrupted data can swallow the packages behind it,
+      //resync on the next header that carries a valid package
+      size_t next = pos + 1;
+      size_t need = 0;
 
-          case 9:
-            CheckSum += (currentByte * 0x100);
-            break;
+      while ((next += findPackageHeader(data + next, pos + package_size - next,
+                                        PH)) < pos + package_size) {
+        if (isPackageValid(data + next, size - next, need) || need) {
+          break;
         }
 
-        packageBuffer[recvPos++] = currentByte;
+        next++;
       }
 
-      if (recvPos  == PackagePaidBytes) {
-        package_recvPos = recvPos;
-        break;
+      if (next < pos + package_size) {
+        if (need) {
+          remain = need;
+          break;
+        }
+
+        pos = next;
+        continue;
       }
     }
 
-    if (PackagePaidBytes == recvPos) {
-      startTs = getms();
-      recvPos = 0;
-
-      while ((waitTime = getms() - startTs) <= timeout) {
-        size_t remainSize = package_Sample_Num * PackageSampleBytes - recvPos;
-        size_t recvSize = 0;
-        result_t ans = waitForData(remainSize, timeout - waitTime, &recvSize);
+    if ((package_CT & 0x01) == CT_RingStart) {
+      scan_frequence = (package_CT & 0xFE) >> 1;
+    }
 
-        if (!IS_OK(ans)) {
-          return ans;
-        }
+    uint16_t FirstSampleAngle = FirstSampleAngleCal >> 1;
+    uint16_t LastSampleAngle = LastSampleAngleCal >> 1;
+    float IntervalSampleAngle = 0.0;
 
-        if (recvSize > remainSize) {
-          recvSize = remainSize;
+    if (package_Sample_Num > 1) {
+      if (LastSampleAngle < FirstSampleAngle) {
+        if ((FirstSampleAngle > 270 * 64) && (LastSampleAngle < 90 * 64)) {
+          IntervalSampleAngle = (float)((360 * 64 + LastSampleAngle -
+                                         FirstSampleAngle) / ((package_Sample_Num - 1) * 1.0));
+          IntervalSampleAngle_LastPackage = IntervalSampleAngle;
+        } else {
+          IntervalSampleAngle = IntervalSampleAngle_LastPackage;
         }
+      } else {
+        IntervalSampleAngle = (float)((LastSampleAngle - FirstSampleAngle) / ((
+                                        package_Sample_Num - 1) * 1.0));
+        IntervalSampleAngle_LastPackage = IntervalSampleAngle;
+      }
+    }
 
-        getData(globalRecvBuffer, recvSize);
-
-        for (size_t pos = 0; pos < recvSize; ++pos) {
-          if (m_intensities) {
-            if (recvPos % 3 == 2) {
-              Valu8Tou16 += globalRecvBuffer[pos] * 0x100;
-              CheckSumCal ^= Valu8Tou16;
-            } else if (recvPos % 3 == 1) {
-              Valu8Tou16 = globalRecvBuffer[pos];
-            } else {
-              CheckSumCal ^= globalRecvBuffer[pos];
-            }
-          } else {
-            if (recvPos % 2 == 1) {
-              Valu8Tou16 += globalRecvBuffer[pos] * 0x100;
-              CheckSumCal ^= Valu8Tou16;
-            } else {
-              Valu8Tou16 = globalRecvBuffer[pos];
-            }
-          }
+    node_sample package_node;
+    package_node.sync_quality = Node_Default_Quality;
+    package_node.angle_q6_checkbit = LIDAR_RESP_MEASUREMENT_CHECKBIT;
+    package_node.distance_q2 = 0;
+    package_node.sync_flag = Node_NotSync;
+    package_node.reserved = 0;
 
-          packageBuffer[package_recvPos + recvPos] = globalRecvBuffer[pos];
-          recvPos++;
+    if ((package_CT & 0x01) == CT_Normal) {
+      if (!has_package_error) {
+        if (package_index < 10) {
+          info.debug_info[package_index] = (package_CT >> 1);
+          info.debug_mask |= (1 << package_index);
         }
 
-        if (package_Sample_Num * PackageSampleBytes == recvPos) {
-          package_recvPos += recvPos;
-          break;
-        }
+        package_index++;
+      } else {
+        package_index = 0;
       }
+    } else {
+      package_index = 0;
 
-      if (package_Sample_Num * PackageSampleBytes != recvPos) {
-        return RESULT_FAIL;
+      if (CheckSumResult) {
+        has_package_error = false;
+        package_node.sync_flag = Node_Sync;
+        info.scan_frequence = scan_frequence;
       }
-    } else {
-      return RESULT_FAIL;
     }
 
-    CheckSumCal ^= SampleNumlAndCTCal;
-    CheckSumCal ^= LastSampleAngleCal;
-
-    if (CheckSumCal != CheckSum) {
-      CheckSumResult = false;
-      has_package_error = true;
+    if (!CheckSumResult) {
+      for (int i = 0; i < package_Sample_Num; i++) {
+        nodebuffer[i] = package_node;
+      }
     } else {
-      CheckSumResult = true;
+      package_decoder(data + pos + PackagePaidBytes, package_Sample_Num,
+                      FirstSampleAngle, IntervalSampleAngle, angleCorrectTable,
+                      package_node, nodebuffer);
     }
 
+    count = package_Sample_Num;
+    used = pos + package_size;
+    return RESULT_OK;
   }
 
-  uint8_t package_CT;
+  used = pos;
+  return RESULT_FAIL;
+}
 
-  if (m_intensities) {
-    package_CT = package.package_CT;
-  } else {
-    package_CT = packages.package_CT;
-  }
+uint16_t YDlidarDriver::packageCheckSum(const uint8_t *data) {
+  const node_packages *header = reinterpret_cast<const node_packages *>(data);
+  uint16_t CheckSumCal = PH ^ header->packageFirstSampleAngle;
+  CheckSumCal ^= packageSampleCheckSum(data + PackagePaidBytes,
+                                       header->nowPackageNum, PackageSampleBytes);
+  CheckSumCal ^= (uint16_t)(header->package_CT | (header->nowPackageNum << 8));
+  CheckSumCal ^= header->packageLastSampleAngle;
+  return CheckSumCal;
+}
 
-  (*node).scan_frequence  = 0;
+bool YDlidarDriver::isPackageValid(const uint8_t *data, size_t size,
+                                   size_t &remain) {
+  remain = 0;
 
-  if ((package_CT & 0x01) == CT_Normal) {
-    (*node).sync_flag = Node_NotSync;
-    memset((*node).debug_info, 0xff, sizeof((*node).debug_info));
+  if (size < PackagePaidBytes) {
+    remain = PackagePaidBytes - size;
+    return false;
+  }
 
-    if (!has_package_error) {
-      if (package_index < 10) {
-        (*node).debug_info[package_index] = (package_CT >> 1);
-        (*node).index = package_index;
-      } else {
-        (*node).index = 0xff;
-      }
+  const node_packages *header = reinterpret_cast<const node_packages *>(data);
 
-      if (package_Sample_Index == 0) {
-        package_index++;
-      }
-    } else {
-      (*node).index = 255;
-      package_index = 0;
-    }
-  } else {
-    (*node).sync_flag = Node_Sync;
-    (*node).index = 255;
-    package_index = 0;
-
-    if (CheckSumResult) {
-      has_package_error = false;
-      (*node).scan_frequence  = scan_frequence;
-    }
+  if (!(header->packageFirstSampleAngle & LIDAR_RESP_MEASUREMENT_CHECKBIT) ||
+      !(header->packageLastSampleAngle & LIDAR_RESP_MEASUREMENT_CHECKBIT) ||
+      header->nowPackageNum == 0) {
+    return false;
   }
 
-  (*node).sync_quality = Node_Default_Quality;
-  (*node).stamp = 0;
+  size_t package_size = PackagePaidBytes + header->nowPackageNum *
+                        PackageSampleBytes;
 
-  if (CheckSumResult) {
-    if (m_intensities) {
-      (*node).sync_quality = ((uint16_t)((
-                                           package.packageSample[package_Sample_Index].PakageSampleDistance
-                                           & 0x03) << LIDAR_RESP_MEASUREMENT_ANGLE_SAMPLE_SHIFT) |
-                              (package.packageSample[package_Sample_Index].PakageSampleQuality));
-      (*node).distance_q2 =
-        package.packageSample[package_Sample_Index].PakageSampleDistance & 0xfffc;
-    } else {
-      (*node).distance_q2 = packages.packageSampleDistance[package_Sample_Index];
-
-      if (!isTOFLidar(m_LidarType)) {
-        (*node).sync_quality = ((uint16_t)(0xfc |
-                                           packages.packageSampleDistance[package_Sample_Index] & 0x0003)) <<
-                               LIDAR_RESP_MEASUREMENT_QUALITY_SHIFT;
-      }
+  if (size < package_size) {
+    remain = package_size - size;
+    return false;
+  }
 
-    }
+  return packageCheckSum(data) == header->checkSum;
+}
 
-    if ((*node).distance_q2 != 0) {
-      if (!isTOFLidar(m_LidarType)) {
-        if (isOctaveLidar(model)) {
-          AngleCorrectForDistance = (int32_t)(((atan(((21.8 * (155.3 - ((
-                                                  *node).distance_q2 / 2.0))) / 155.3) / ((
-                                                      *node).distance_q2 / 2.0))) * 180.0 / 3.1415) * 64.0);
-        } else  {
-          AngleCorrectForDistance = (int32_t)(((atan(((21.8 * (155.3 - ((
-                                                  *node).distance_q2 / 4.0))) / 155.3) / ((
-                                                      *node).distance_q2 / 4.0))) * 180.0 / 3.1415) * 64.0);
-        }
-      }
+result_t YDlidarDriver::waitPackage(node_sample *nodebuffer, size_t &count,
+                                    scan_info &info, uint32_t timeout) {
+  uint32_t startTs    = getms();
+  uint32_t waitTime   = 0;
+  size_t   used       = 0;
+  size_t   remain     = PackagePaidBytes;
 
+  while ((waitTime = getms() - startTs) <= timeout) {
+    if (globalRecvPos < globalRecvSize) {
+      result_t ans = parsePackage(globalRecvBuffer + globalRecvPos,
+                                  globalRecvSize - globalRecvPos, used, remain,
+                                  nodebuffer, count, info);
+      globalRecvPos += used;
 
+      if (IS_OK(ans)) {
+        return RESULT_OK;
+      }
+    }
 
-    } else {
-      AngleCorrectForDistance = 0;
+    //move the incomplete package to the front of the buffer
+    if (globalRecvPos > 0) {
+      globalRecvSize -= globalRecvPos;
+      memmove(globalRecvBuffer, globalRecvBuffer + globalRecvPos, globalRecvSize);
+      globalRecvPos = 0;
     }
 
-    float sampleAngle = IntervalSampleAngle * package_Sample_Index;
+    //batched mode: sleep until the next wakeup once the tty queue is drained
+    if (m_WakeupRate > 0 && _serial->available() < remain) {
+      waitWakeupInterval();
+      waitTime = getms() - startTs;
 
-    if ((FirstSampleAngle + sampleAngle +
-         AngleCorrectForDistance) < 0) {
-      (*node).angle_q6_checkbit = (((uint16_t)(FirstSampleAngle + sampleAngle +
-                                    AngleCorrectForDistance + 23040)) << LIDAR_RESP_MEASUREMENT_ANGLE_SHIFT) +
-                                  LIDAR_RESP_MEASUREMENT_CHECKBIT;
-    } else {
-      if ((FirstSampleAngle + sampleAngle + AngleCorrectForDistance) > 23040) {
-        (*node).angle_q6_checkbit = (((uint16_t)(FirstSampleAngle + sampleAngle +
-                                      AngleCorrectForDistance - 23040)) << LIDAR_RESP_MEASUREMENT_ANGLE_SHIFT) +
-                                    LIDAR_RESP_MEASUREMENT_CHECKBIT;
-      } else {
-        (*node).angle_q6_checkbit = (((uint16_t)(FirstSampleAngle + sampleAngle +
-                                      AngleCorrectForDistance)) << LIDAR_RESP_MEASUREMENT_ANGLE_SHIFT) +
-                                    LIDAR_RESP_MEASUREMENT_CHECKBIT;
+      //a quiet line, same as waitForData timing out
+      if (waitTime > timeout) {
+        count = 0;
+        return RESULT_TIMEOUT;
       }
     }
-  } else {
-    (*node).sync_flag       = Node_NotSync;
-    (*node).sync_quality    = Node_Default_Quality;
-    (*node).angle_q6_checkbit = LIDAR_RESP_MEASUREMENT_CHECKBIT;
-    (*node).distance_q2      = 0;
-    (*node).scan_frequence  = 0;
-  }
 
+    size_t recvSize = 0;
+    result_t ans = waitForData(remain, timeout - waitTime, &recvSize);
 
-  uint8_t nowPackageNum;
+    if (!IS_OK(ans)) {
+      count = 0;
+      return ans;
+    }
 
-  if (m_intensities) {
-    nowPackageNum = package.nowPackageNum;
-  } else {
-    nowPackageNum = packages.nowPackageNum;
-  }
+    if (recvSize > MAX_RECV_BUFFER_SIZE - globalRecvSize) {
+      recvSize = MAX_RECV_BUFFER_SIZE - globalRecvSize;
+    }
 
-  package_Sample_Index++;
+    ans = getData(globalRecvBuffer + globalRecvSize, recvSize);
+
+    if (IS_FAIL(ans)) {
+      count = 0;
+      return RESULT_FAIL;
+    }
 
-  if (package_Sample_Index >= nowPackageNum) {
-    package_Sample_Index = 0;
-    CheckSumResult = false;
+    globalRecvSize += recvSize;
   }
 
-  return RESULT_OK;
+  count = 0;
+  return RESULT_FAIL;
 }
 
-result_t YDlidarDriver::waitScanData(node_info *nodebuffer, size_t &count,
-                                     uint32_t timeout) {
+result_t YDlidarDriver::waitScanData(node_sample *nodebuffer, size_t &count,
+                                     scan_info &info, uint32_t timeout) {
+  info.stamp = 0;
+  info.scan_frequence = 0;
+  info.debug_mask = 0;
+
   if (!isConnected) {
     count = 0;
     return RESULT_FAIL;
@@ -1073,81 +1195,226 @@ result_t YDlidarDriver::waitScanData(node_info *nodebuffer, size_t &count,
   uint32_t   waitTime         = 0;
   result_t   ans              = RESULT_FAIL;
 
-  while ((waitTime = getms() - startTs) <= timeout && recvNodeCount < count) {
-    node_info node;
-    ans = waitPackage(&node, timeout - waitTime);
+  while ((waitTime = getms() - startTs) <= timeout) {
+    if (count - recvNodeCount < PackageSampleMaxLngth) {
+      count = recvNodeCount;
+      return RESULT_OK;
+    }
+
+    size_t package_count = 0;
+    ans = waitPackage(nodebuffer + recvNodeCount, package_count, info,
+                      timeout - waitTime);
 
     if (!IS_OK(ans)) {
       count = recvNodeCount;
       return ans;
     }
 
-    nodebuffer[recvNodeCount++] = node;
+    node_sample &node = nodebuffer[recvNodeCount];
+    recvNodeCount += package_count;
 
     if (node.sync_flag & LIDAR_RESP_MEASUREMENT_SYNCBIT) {
-      size_t size = _serial->available();
-      uint64_t delayTime = 0;
-      size_t PackageSize = (m_intensities ? INTENSITY_NORMAL_PACKAGE_SIZE :
-                            NORMAL_PACKAGE_SIZE);
-
-      if (size > PackagePaidBytes && size < PackagePaidBytes * PackageSize) {
-        size_t packageNum = size / PackageSize;
-        size_t Number = size % PackageSize;
-        delayTime = packageNum * m_PointTime * PackageSize / 2;
-
-        if (Number > PackagePaidBytes) {
-          delayTime += m_PointTime * ((Number - PackagePaidBytes) / 2);
+      info.stamp = syncPackageDelay();
+      count = recvNodeCount;
+      return RESULT_OK;
+    }
+  }
+
+  count = recvNodeCount;
+  return RESULT_FAIL;
+}
+
+
+uint64_t YDlidarDriver::syncPackageDelay() {
+  size_t size = _serial->available() + globalRecvSize - globalRecvPos;
+  uint64_t delayTime = 0;
+  size_t PackageSize = (m_intensities ? INTENSITY_NORMAL_PACKAGE_SIZE :
+                        NORMAL_PACKAGE_SIZE);
+
+  if (size > PackagePaidBytes && size < PackagePaidBytes * PackageSize) {
+    size_t packageNum = size / PackageSize;
+    size_t Number = size % PackageSize;
+    delayTime = packageNum * m_PointTime * PackageSize / 2;
+
+    if (Number > PackagePaidBytes) {
+      delayTime += m_PointTime * ((Number - PackagePaidBytes) / 2);
+    }
+
+    size = Number;
+
+    if (packageNum > 0 && Number == 0) {
+      size = PackageSize;
+    }
+  }
+
+  return size * trans_delay + delayTime;
+}
+
+void YDlidarDriver::waitWakeupInterval() {
+  uint32_t interval = 1000 / m_WakeupRate;
+
+  //wake up before the receive buffer fills
+  if (trans_delay > 0) {
+    uint32_t max_interval = (uint64_t)MAX_RECV_BUFFER_SIZE * trans_delay / 1000000;
+
+    if (interval > max_interval) {
+      interval = max_interval;
+    }
+  }
+
+  uint32_t elapsed = getms() - last_wakeup_time;
+
+  if (elapsed < interval) {
+    delay(interval - elapsed);
+  }
+
+  last_wakeup_time = getms();
+}
+
+void YDlidarDriver::publishScanData() {
+  switch (m_ScanQueuePolicy) {
+    case QUEUE_DROP_NEWEST:
+      if (!scan_queue->push()) {
+        scan_queue_overflow++;
+        return;
+      }
+
+      break;
+
+    case QUEUE_BLOCK:
+      if (!scan_queue->push()) {
+        scan_queue_overflow++;
+
+        //never stall the reactor shared with other lidars
+        if (lidar_managed) {
+          return;
         }
 
-        size = Number;
+        while (isScanning && !scan_queue->push()) {
+          _queueEvent.wait(100);
+        }
+      }
+
+      break;
 
-        if (packageNum > 0 && Number == 0) {
-          size = PackageSize;
+    default:
+      if (!scan_queue->push()) {
+        if (scan_queue->dropOldest()) {
+          scan_queue_overflow++;
         }
+
+        scan_queue->push();
       }
 
-      nodebuffer[recvNodeCount - 1].stamp = size * trans_delay + delayTime;
-      nodebuffer[recvNodeCount - 1].scan_frequence = node.scan_frequence;
-      count = recvNodeCount;
-      return RESULT_OK;
+      break;
+  }
+
+  _dataEvent.set();
+
+  if (scan_published) {
+    scan_published(scan_published_context);
+  }
+}
+
+result_t YDlidarDriver::waitScanBuffer(uint32_t timeout) {
+  uint32_t startTs = getms();
+  uint32_t waitTime = 0;
+
+  while (!scan_queue->pop()) {
+    waitTime = getms() - startTs;
+
+    if (waitTime >= timeout) {
+      return RESULT_TIMEOUT;
     }
 
-    if (recvNodeCount == count) {
-      return RESULT_OK;
+    switch (_dataEvent.wait(timeout - waitTime)) {
+      case Event::EVENT_TIMEOUT:
+        return RESULT_TIMEOUT;
+
+      case Event::EVENT_OK:
+        if (!isScanning) {
+          return RESULT_FAIL;
+        }
+
+        break;
+
+      default:
+        return RESULT_FAIL;
     }
   }
 
-  count = recvNodeCount;
-  return RESULT_FAIL;
+  if (m_ScanQueuePolicy == QUEUE_BLOCK) {
+    _queueEvent.set();
+  }
+
+  return RESULT_OK;
 }
 
+result_t YDlidarDriver::grabScanData(node_sample *nodebuffer, size_t &count,
+                                     scan_info &info, uint32_t timeout) {
+  result_t ans = waitScanBuffer(timeout);
+
+  if (!IS_OK(ans)) {
+    count = 0;
+    return ans;
+  }
+
+  const ScanBuffer &scan = scan_queue->readBuffer();
+  size_t size_to_copy = min(count, scan.count);
+  memcpy(nodebuffer, scan.nodes, size_to_copy * sizeof(node_sample));
+  count = size_to_copy;
+  info = scan.info;
+  return RESULT_OK;
+}
 
 result_t YDlidarDriver::grabScanData(node_info *nodebuffer, size_t &count,
                                      uint32_t timeout) {
-  switch (_dataEvent.wait(timeout)) {
-    case Event::EVENT_TIMEOUT:
-      count = 0;
-      return RESULT_TIMEOUT;
+  result_t ans = waitScanBuffer(timeout);
 
-    case Event::EVENT_OK: {
-      if (scan_node_count == 0) {
-        return RESULT_FAIL;
-      }
+  if (!IS_OK(ans)) {
+    count = 0;
+    return ans;
+  }
+
+  const ScanBuffer &scan = scan_queue->readBuffer();
+  size_t size_to_copy = min(count, scan.count);
+  int debug_index = 0;
+
+  for (size_t i = 0; i < size_to_copy; i++) {
+    node_info &node = nodebuffer[i];
+    node.sync_flag = scan.nodes[i].sync_flag;
+    node.sync_quality = scan.nodes[i].sync_quality;
+    node.angle_q6_checkbit = scan.nodes[i].angle_q6_checkbit;
+    node.distance_q2 = scan.nodes[i].distance_q2;
+    node.stamp = 0;
+    node.scan_frequence = 0;
+    node.index = 0xff;
+    memset(node.debug_info, 0xff, sizeof(node.debug_info));
 
-      ScopedLocker l(_lock);
-      size_t size_to_copy = min(count, scan_node_count);
-      memcpy(nodebuffer, scan_node_buf, size_to_copy * sizeof(node_info));
-      count = size_to_copy;
-      scan_node_count = 0;
+    //one valid debug index per node, as the packages carried them
+    while (debug_index < _countof(node.debug_info) &&
+           !(scan.info.debug_mask & (1 << debug_index))) {
+      debug_index++;
     }
 
-    return RESULT_OK;
+    if (debug_index < _countof(node.debug_info)) {
+      node.index = debug_index;
+      node.debug_info[debug_index] = scan.info.debug_info[debug_index];
+      debug_index++;
+    }
+  }
 
-    default:
-      count = 0;
-      return RESULT_FAIL;
+  if (size_to_copy > 0) {
+    nodebuffer[0].stamp = scan.info.stamp;
+    nodebuffer[0].scan_frequence = scan.info.scan_frequence;
   }
 
+  count = size_to_copy;
+  return RESULT_OK;
+}
+
+uint32_t YDlidarDriver::getScanQueueOverflowCount() const {
+  return scan_queue_overflow;
 }
 
 
@@ -1241,18 +1508,7 @@ result_t YDlidarDriver::ascendScanData(node_info *nodebuffer, size_t count) {
     pre_degree = degree;
   }
 
-  node_info *tmpbuffer = new node_info[count];
-
-  for (i = (int)zero_pos; i < (int)count; i++) {
-    tmpbuffer[i - zero_pos] = nodebuffer[i];
-  }
-
-  for (i = 0; i < (int)zero_pos; i++) {
-    tmpbuffer[i + (int)count - zero_pos] = nodebuffer[i];
-  }
-
-  memcpy(nodebuffer, tmpbuffer, count * sizeof(node_info));
-  delete[] tmpbuffer;
+  std::rotate(nodebuffer, nodebuffer + zero_pos, nodebuffer + count);
 
   return RESULT_OK;
 }
@@ -1361,8 +1617,10 @@ result_t YDlidarDriver::getDeviceInfo(device_info &info, uint32_t timeout) {
 
     getData(reinterpret_cast<uint8_t *>(&info), sizeof(info));
     model = info.model;
+    model_info = &lidarModelInfo(model);
   }
 
+  updatePackageDecoder();
   return RESULT_OK;
 }
 
@@ -1371,13 +1629,8 @@ result_t YDlidarDriver::getDeviceInfo(device_info &info, uint32_t timeout) {
 /************************************************************************/
 void YDlidarDriver::setIntensities(const bool &isintensities) {
   if (m_intensities != isintensities) {
-    if (globalRecvBuffer) {
-      delete[] globalRecvBuffer;
-      globalRecvBuffer = NULL;
-    }
-
-    globalRecvBuffer = new uint8_t[isintensities ? sizeof(node_package) : sizeof(
-                                     node_packages)];
+    globalRecvPos = 0;
+    globalRecvSize = 0;
   }
 
   m_intensities = isintensities;
@@ -1387,6 +1640,8 @@ void YDlidarDriver::setIntensities(const bool &isintensities) {
   } else {
     PackageSampleBytes = 2;
   }
+
+  updatePackageDecoder();
 }
 /**
 * @brief 设置雷达异常自动重新连接 \n
@@ -1402,47 +1657,51 @@ void YDlidarDriver::setAutoReconnect(const bool &enable) {
 void YDlidarDriver::checkTransDelay() {
   //calc stamp
   trans_delay = _serial->getByteTime();
-  sample_rate = lidarModelDefaultSampleRate(model) * 1000;
-
-  switch (model) {
-    case YDLIDAR_G4://g4
-    case YDLIDAR_G5:
-    case YDLIDAR_G4PRO:
-    case YDLIDAR_F4PRO:
-    case YDLIDAR_G6://g6
-    case YDLIDAR_G7:
-    case YDLIDAR_TG15:
-    case YDLIDAR_TG30:
-    case YDLIDAR_TG50:
-      if (m_sampling_rate == -1) {
-        sampling_rate _rate;
-        _rate.rate = 0;
-        getSamplingRate(_rate);
-        m_sampling_rate = _rate.rate;
-      }
+  sample_rate = model_info->default_sample_rate * 1000;
 
-      sample_rate = ConvertLidarToUserSmaple(model, m_sampling_rate);
-      sample_rate *= 1000;
+  if (model_info->hasSampleRate()) {
+    if (m_sampling_rate == -1) {
+      sampling_rate _rate;
+      _rate.rate = 0;
+      getSamplingRate(_rate);
+      m_sampling_rate = _rate.rate;
+    }
 
-      break;
+    sample_rate = ConvertLidarToUserSmaple(model, m_sampling_rate);
+    sample_rate *= 1000;
+  }
 
-    case YDLIDAR_G2C:
-      sample_rate = 4000;
-      break;
+  m_PointTime = 1e9 / sample_rate;
+}
 
-    case YDLIDAR_G1:
-      sample_rate = 9000;
-      break;
+void YDlidarDriver::updatePackageDecoder() {
+  package_decoder = selectPackageDecoder(m_intensities, isTOFLidar(m_LidarType));
+}
 
-    case YDLIDAR_G4C:
-      sample_rate = 4000;
-      break;
+void YDlidarDriver::updateAngleCorrectTable() {
+  if (isTOFLidar(m_LidarType)) {
+    return;
+  }
 
-    default:
-      break;
+  int scale = model_info->isOctave() ? 2 : 4;
+
+  if (angleCorrectTable && angleCorrectScale == scale) {
+    return;
   }
 
-  m_PointTime = 1e9 / sample_rate;
+  if (!angleCorrectTable) {
+    angleCorrectTable = new int16_t[UINT16_MAX + 1];
+  }
+
+  angleCorrectTable[0] = 0;
+
+  for (uint32_t i = 1; i <= UINT16_MAX; i++) {
+    double distance = i / (double)scale;
+    angleCorrectTable[i] = (int16_t)((int32_t)(((atan(((21.8 * (155.3 - distance)) /
+                                      155.3) / distance)) * 180.0 / 3.1415) * 64.0));
+  }
+
+  angleCorrectScale = scale;
 }
 
 /************************************************************************/
@@ -1461,6 +1720,8 @@ result_t YDlidarDriver::startScan(bool force, uint32_t timeout) {
 
   stop();
   checkTransDelay();
+  updateAngleCorrectTable();
+  updatePackageDecoder();
   flushSerial();
   delay(30);
   {
@@ -1515,6 +1776,35 @@ result_t YDlidarDriver::stopScan(uint32_t timeout) {
 }
 
 result_t YDlidarDriver::createThread() {
+  if (m_ScanQueueSize < 1) {
+    m_ScanQueueSize = 1;
+  }
+
+  if (scan_queue->capacity() != (size_t)m_ScanQueueSize) {
+    delete scan_queue;
+    scan_queue = new BufferQueue<ScanBuffer>(m_ScanQueueSize);
+    scan_queue_overflow = 0;
+  }
+
+  if (lidar_manager) {
+    //parse in the shared reactor thread instead of a thread of our own
+    resetScanCache();
+
+    if (m_SingleChannel) {
+      waitDevicePackage();
+    }
+
+    flushSerial();
+    last_data_time = getms();
+    wait_scan_start = true;
+    isScanning = true;
+    lidar_managed = lidar_manager->add(this);
+
+    if (lidar_managed) {
+      return RESULT_OK;
+    }
+  }
+
   _thread = CLASS_THREAD(YDlidarDriver, cacheScanData);
 
   if (_thread.getHandle() == 0) {
@@ -0,0 +1,249 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, EAIBOT, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+/*
+ * Checks that converting a revolution does not touch the heap once the
+ * scan buffers have been used once: operator new and posix_memalign (behind
+ * AlignedAllocator) are replaced by counters and scans are fed straight into
+ * the driver's scan queue, no lidar needed.
+ */
+#include "CYdLidar.h"
+#include "scan_pool.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+#include <new>
+
+using namespace ydlidar;
+
+static std::atomic<long> allocations(0);
+
+void *operator new(size_t size) {
+  allocations++;
+  void *p = malloc(size ? size : 1);
+
+  if (!p) {
+    throw std::bad_alloc();
+  }
+
+  return p;
+}
+
+void *operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+  free(p);
+}
+
+void operator delete[](void *p) noexcept {
+  free(p);
+}
+
+#if !defined(_WIN32)
+//LaserScanSoA arrays, AlignedAllocator frees them with free()
+extern "C" int posix_memalign(void **p, size_t alignment, size_t size) {
+  allocations++;
+  *p = aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+  return *p ? 0 : ENOMEM;
+}
+#endif
+
+namespace ydlidar {
+namespace test {
+struct Access {
+  static void start(CYdLidar &lidar) {
+    lidar.lidarPtr = new YDlidarDriver();
+    lidar.lidarPtr->isScanning = true;
+    lidar.isScanning = true;
+  }
+
+  /// queue one revolution of count nodes
+  static void pushScan(CYdLidar &lidar, int count, unsigned &seed) {
+    YDlidarDriver::ScanBuffer &scan = lidar.lidarPtr->scan_queue->writeBuffer();
+    scan.count = count;
+    memset(&scan.info, 0, sizeof(scan.info));
+
+    for (int i = 0; i < count; i++) {
+      seed = seed * 1103515245 + 12345;
+      node_sample &node = scan.nodes[i];
+      node.sync_flag = i == 0 ? Node_Sync : Node_NotSync;
+      node.sync_quality = (seed >> 8) % 1024;
+      node.angle_q6_checkbit = ((i * 23040 / count + (seed >> 4) % 40) % 23040) <<
+                               LIDAR_RESP_MEASUREMENT_ANGLE_SHIFT | LIDAR_RESP_MEASUREMENT_CHECKBIT;
+      node.distance_q2 = (seed >> 12) % 8 ? (seed >> 16) % 40000 : 0;
+    }
+
+    lidar.lidarPtr->scan_queue->push();
+  }
+};
+}
+}
+
+namespace {
+enum {
+  WARM_UP = 3,        ///< revolutions before counting
+  REVOLUTIONS = 100,  ///< counted revolutions
+  NODES = 1000,       ///< nodes per revolution
+};
+
+int failures = 0;
+
+void report(const char *name, bool fixed, long count) {
+  printf("%-28s fixed %d: %ld allocations in %d revolutions %s\n", name,
+         fixed, count, REVOLUTIONS, count ? "FAILED" : "ok");
+
+  if (count) {
+    failures++;
+  }
+}
+
+bool revolution(CYdLidar &lidar, LaserScan &scan, unsigned &seed) {
+  bool hardError;
+  test::Access::pushScan(lidar, NODES, seed);
+  return lidar.doProcessSimple(scan, hardError);
+}
+
+bool revolution(CYdLidar &lidar, LaserScanSoA &scan, unsigned &seed) {
+  bool hardError;
+  test::Access::pushScan(lidar, NODES, seed);
+  return lidar.doProcessSimple(scan, hardError);
+}
+
+void checkReusedScan(bool fixed) {
+  CYdLidar lidar;
+  lidar.setFixedResolution(fixed);
+  test::Access::start(lidar);
+  unsigned seed = 1;
+  LaserScan scan;
+
+  for (int i = 0; i < WARM_UP; i++) {
+    revolution(lidar, scan, seed);
+  }
+
+  long start = allocations;
+
+  for (int i = 0; i < REVOLUTIONS; i++) {
+    revolution(lidar, scan, seed);
+  }
+
+  report("reused LaserScan", fixed, allocations - start);
+}
+
+void checkPooledScan(bool fixed) {
+  CYdLidar lidar;
+  lidar.setFixedResolution(fixed);
+  test::Access::start(lidar);
+  unsigned seed = 2;
+  ScanPool<LaserScan> pool;
+
+  for (int i = 0; i < WARM_UP; i++) {
+    LaserScan scan = pool.acquire();
+    revolution(lidar, scan, seed);
+    pool.release(scan);
+  }
+
+  long start = allocations;
+
+  for (int i = 0; i < REVOLUTIONS; i++) {
+    LaserScan scan = pool.acquire();
+    revolution(lidar, scan, seed);
+    pool.release(scan);
+  }
+
+  report("ScanPool<LaserScan>", fixed, allocations - start);
+}
+
+void checkPooledSoA(bool fixed) {
+  CYdLidar lidar;
+  lidar.setFixedResolution(fixed);
+  lidar.setScanFields(SCAN_FIELD_ALL);
+  test::Access::start(lidar);
+  unsigned seed = 3;
+  ScanPool<LaserScanSoA> pool;
+  LaserScanSoA scan = pool.acquire();
+
+  for (int i = 0; i < WARM_UP; i++) {
+    revolution(lidar, scan, seed);
+    pool.release(scan);
+    scan = pool.acquire();
+  }
+
+  long start = allocations;
+
+  for (int i = 0; i < REVOLUTIONS; i++) {
+    revolution(lidar, scan, seed);
+    pool.release(scan);
+    scan = pool.acquire();
+  }
+
+  report("ScanPool<LaserScanSoA>", fixed, allocations - start);
+}
+
+void checkBorrowedScan(bool fixed) {
+  CYdLidar lidar;
+  lidar.setFixedResolution(fixed);
+  test::Access::start(lidar);
+  unsigned seed = 4;
+  LaserScanLease lease;
+  bool hardError;
+
+  for (int i = 0; i < WARM_UP; i++) {
+    test::Access::pushScan(lidar, NODES, seed);
+    lidar.borrowScan(lease, hardError);
+  }
+
+  long start = allocations;
+
+  for (int i = 0; i < REVOLUTIONS; i++) {
+    test::Access::pushScan(lidar, NODES, seed);
+    lidar.borrowScan(lease, hardError);
+  }
+
+  report("borrowScan", fixed, allocations - start);
+}
+}
+
+int main() {
+  for (int fixed = 0; fixed < 2; fixed++) {
+    checkReusedScan(fixed);
+    checkPooledScan(fixed);
+    checkPooledSoA(fixed);
+    checkBorrowedScan(fixed);
+  }
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,162 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, EAIBOT, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+/*
+ * Compares the packageSampleCheckSum implementations with the per-sample
+ * 16-bit loop the driver used before: every implementation must match it
+ * for all sample counts and alignments, then each is timed in ns/packet.
+ * Fails only on a mismatch, the timings are informational.
+ */
+#include "ydlidar_checksum.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace ydlidar;
+
+namespace {
+enum {
+  MAX_SAMPLES = 300,      ///< largest sample count checked
+  ITERATIONS = 200000,    ///< packets per timing
+};
+
+const char *const IMPL_NAMES[CHECKSUM_Tail] = {"scalar", "sse2", "avx2"};
+
+//the loop parsePackage used before packageSampleCheckSum
+uint16_t referenceCheckSum(const uint8_t *samples, size_t count,
+                           int sample_bytes) {
+  uint16_t checksum = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    const uint8_t *sample = samples + i * sample_bytes;
+
+    if (sample_bytes == 3) {
+      checksum ^= sample[0];
+      checksum ^= (uint16_t)(sample[1] | (sample[2] << 8));
+    } else {
+      checksum ^= (uint16_t)(sample[0] | (sample[1] << 8));
+    }
+  }
+
+  return checksum;
+}
+
+//called through a pointer like the others, so it isn't inlined into the loop
+double nsPerPacket(PackageCheckSumFunc func, const uint8_t *samples,
+                   size_t count, int sample_bytes) {
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  uint16_t sink = 0;
+
+  for (int i = 0; i < ITERATIONS; i++) {
+    sink ^= func(samples, count, sample_bytes);
+  }
+
+  double ns = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start).count();
+  //keep the loop from being optimized away
+  volatile uint16_t keep = sink;
+  (void)keep;
+  return ns / ITERATIONS;
+}
+}
+
+int main() {
+  std::vector<uint8_t> data(MAX_SAMPLES * 3 + 64);
+
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = rand() & 0xFF;
+  }
+
+  int mismatches = 0;
+
+  for (int sample_bytes = 2; sample_bytes <= 3; sample_bytes++) {
+    for (size_t count = 0; count <= MAX_SAMPLES; count++) {
+      for (size_t offset = 0; offset < 32; offset += 7) {
+        const uint8_t *samples = &data[offset];
+        uint16_t expected = referenceCheckSum(samples, count, sample_bytes);
+
+        if (packageSampleCheckSum(samples, count, sample_bytes) != expected) {
+          mismatches++;
+        }
+
+        for (int impl = 0; impl < CHECKSUM_Tail; impl++) {
+          PackageCheckSumFunc func = packageSampleCheckSumImpl(impl);
+
+          if (func && func(samples, count, sample_bytes) != expected) {
+            printf("%s mismatch: %d bytes, %d samples, offset %d\n",
+                   IMPL_NAMES[impl], sample_bytes, (int)count, (int)offset);
+            mismatches++;
+          }
+        }
+      }
+    }
+  }
+
+  printf("layout   samples  reference");
+
+  for (int impl = 0; impl < CHECKSUM_Tail; impl++) {
+    printf(" %9s", IMPL_NAMES[impl]);
+  }
+
+  printf("   [ns/packet]\n");
+  const size_t counts[] = {40, 64, 128, 255};
+
+  for (int sample_bytes = 2; sample_bytes <= 3; sample_bytes++) {
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+      const uint8_t *samples = &data[1];
+      size_t count = counts[c];
+      printf("%d bytes  %7d  %9.1f", sample_bytes, (int)count,
+             nsPerPacket(referenceCheckSum, samples, count, sample_bytes));
+
+      for (int impl = 0; impl < CHECKSUM_Tail; impl++) {
+        PackageCheckSumFunc func = packageSampleCheckSumImpl(impl);
+
+        if (func) {
+          printf(" %9.1f", nsPerPacket(func, samples, count, sample_bytes));
+        } else {
+          printf(" %9s", "-");
+        }
+      }
+
+      printf("\n");
+    }
+  }
+
+  if (mismatches) {
+    printf("%d mismatches\n", mismatches);
+    return 1;
+  }
+
+  return 0;
+}